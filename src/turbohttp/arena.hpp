@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+
+namespace turbo::http
+{
+
+/**
+ * Scratch memory that lives inside a request and is released by request::reset(), for the values
+ * decoded from a request, e.g. percent decoded paths, query values or a decoded Authorization
+ * header.  Allocations are bumped from the inline storage, once it is full they spill into blocks
+ * from the upstream resource if one is set, otherwise std::bad_alloc is thrown the same as any
+ * std::pmr resource without an upstream.  Deallocating is a no-op, everything is released at once.
+ *
+ * The arena is a std::pmr::memory_resource so std::pmr containers can allocate from it.  Copying
+ * or moving an arena gives an empty arena with the same upstream, values allocated from the
+ * original are not copied.
+ *
+ * @tparam capacity The bytes of inline storage, see the policy's arena_bytes.
+ */
+template<std::size_t capacity>
+class request_arena : public std::pmr::memory_resource
+{
+public:
+    // User provided so even a value initialized arena leaves the inline storage uninitialized.
+    request_arena() { }
+    ~request_arena() override { release(); }
+
+    request_arena(const request_arena& other)
+        : std::pmr::memory_resource(),
+          m_upstream(other.m_upstream)
+    {
+    }
+    request_arena(request_arena&& other)
+        : std::pmr::memory_resource(),
+          m_upstream(other.m_upstream)
+    {
+    }
+    auto operator=(const request_arena& other) -> request_arena&
+    {
+        if(this != &other)
+        {
+            release();
+            m_upstream = other.m_upstream;
+        }
+        return *this;
+    }
+    auto operator=(request_arena&& other) -> request_arena&
+    {
+        return *this = static_cast<const request_arena&>(other);
+    }
+
+    /**
+     * Sets the resource to spill into once the inline storage is full.
+     * @param upstream The resource, nullptr to disable spilling.
+     */
+    auto upstream(std::pmr::memory_resource* upstream) -> void
+    {
+        release();
+        m_upstream = (upstream == nullptr) ? std::pmr::null_memory_resource() : upstream;
+    }
+
+    /**
+     * Copies 'value' into the arena.
+     * @return The copy.
+     */
+    auto copy(std::string_view value) -> std::string_view
+    {
+        auto* data = static_cast<char*>(allocate(value.length(), 1));
+        std::memcpy(data, value.data(), value.length());
+        return std::string_view{data, value.length()};
+    }
+
+    /**
+     * Releases every allocation, spilled blocks are returned to the upstream resource.
+     */
+    auto release() -> void
+    {
+        while(m_spilled != nullptr)
+        {
+            auto* block = m_spilled;
+            m_spilled = block->next;
+            m_upstream->deallocate(block, block->size, alignof(std::max_align_t));
+        }
+        m_used = 0;
+        m_spill_cursor = nullptr;
+        m_spill_remaining = 0;
+        m_spilled_bytes = 0;
+    }
+
+    /**
+     * @return The bytes of the inline storage in use.
+     */
+    auto used() const -> std::size_t { return m_used; }
+
+    /**
+     * @return The bytes allocated from the upstream resource.
+     */
+    auto spilled() const -> std::size_t { return m_spilled_bytes; }
+
+private:
+    /// The header of each block allocated from the upstream resource.
+    struct spill_block
+    {
+        spill_block* next;
+        std::size_t size;
+    };
+
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override
+    {
+        if(void* p = bump(m_storage.data(), capacity, m_used, bytes, alignment); p != nullptr)
+        {
+            return p;
+        }
+
+        std::size_t spill_used = 0;
+        if(m_spill_cursor != nullptr)
+        {
+            if(void* p = bump(m_spill_cursor, m_spill_remaining, spill_used, bytes, alignment); p != nullptr)
+            {
+                m_spill_cursor += spill_used;
+                m_spill_remaining -= spill_used;
+                return p;
+            }
+        }
+
+        // A new block at least as large as the inline storage, throws if there is no upstream.
+        std::size_t size = sizeof(spill_block) + std::max(capacity, bytes + alignment);
+        auto* block = static_cast<spill_block*>(m_upstream->allocate(size, alignof(std::max_align_t)));
+        *block = spill_block{m_spilled, size};
+        m_spilled = block;
+        m_spilled_bytes += size;
+        m_spill_cursor = reinterpret_cast<std::byte*>(block + 1);
+        m_spill_remaining = size - sizeof(spill_block);
+
+        spill_used = 0;
+        void* p = bump(m_spill_cursor, m_spill_remaining, spill_used, bytes, alignment);
+        m_spill_cursor += spill_used;
+        m_spill_remaining -= spill_used;
+        return p;
+    }
+
+    auto do_deallocate(void*, std::size_t, std::size_t) -> void override { }
+
+    auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+    /**
+     * Bumps 'bytes' aligned to 'alignment' from the region, 'used' is advanced past them.
+     * @return The allocation, nullptr if it does not fit.
+     */
+    static auto bump(std::byte* region, std::size_t size, std::size_t& used, std::size_t bytes, std::size_t alignment) -> void*
+    {
+        auto address = reinterpret_cast<std::uintptr_t>(region) + used;
+        std::size_t padding = (alignment - (address % alignment)) % alignment;
+        if(bytes + padding > size - used)
+        {
+            return nullptr;
+        }
+        used += padding + bytes;
+        return region + (used - bytes);
+    }
+
+    /// The inline storage.
+    alignas(std::max_align_t) std::array<std::byte, capacity> m_storage;
+    /// The bytes of the inline storage in use.
+    std::size_t m_used{0};
+    /// The resource spilled into once the inline storage is full.
+    std::pmr::memory_resource* m_upstream{std::pmr::null_memory_resource()};
+    /// The blocks allocated from the upstream resource, most recent first.
+    spill_block* m_spilled{nullptr};
+    /// The free space of the most recent block.
+    std::byte* m_spill_cursor{nullptr};
+    std::size_t m_spill_remaining{0};
+    /// The bytes allocated from the upstream resource.
+    std::size_t m_spilled_bytes{0};
+};
+
+/**
+ * The disabled request arena.
+ */
+template<>
+class request_arena<0>
+{
+public:
+    auto release() -> void { }
+};
+
+} // namespace turbo::http
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "turbohttp/parser.hpp"
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+namespace turbo::http
+{
+
+/// How many entries ahead of the one being parsed are prefetched.
+inline constexpr std::size_t batch_prefetch_distance = 4;
+/// How many bytes of an entry's data are prefetched, enough for the headers of a typical request.
+inline constexpr std::size_t batch_prefetch_bytes = 1024;
+
+/**
+ * One parser and the data it parses with parse_batch().
+ * @tparam parser_type A request or response.
+ */
+template<typename parser_type>
+struct batch_entry
+{
+    using result_type = decltype(std::declval<parser_type&>().parse(std::declval<std::span<char>&>()));
+
+    /// The parser, parse_batch() continues from the parser's current state.
+    parser_type* parser{nullptr};
+    /// The data to parse.
+    std::span<char> data{};
+    /// The result of the parse() call made by parse_batch().
+    result_type result{result_type::incomplete};
+};
+
+/**
+ * Prefetches the first 'batch_prefetch_bytes' of the data for reading.
+ */
+inline auto batch_prefetch(std::span<const char> data) -> void
+{
+    const std::size_t length = (data.size() < batch_prefetch_bytes) ? data.size() : batch_prefetch_bytes;
+    for(std::size_t offset = 0; offset < length; offset += 64)
+    {
+        __builtin_prefetch(data.data() + offset, 0, 3);
+    }
+}
+
+/**
+ * Parses a batch of independent messages, e.g. the buffers of every connection that is ready on
+ * an event loop.  The data of the entry 'batch_prefetch_distance' ahead is prefetched while the
+ * current entry is parsed so the cache misses of cold buffers overlap instead of stalling one
+ * after the other.
+ *
+ * Each entry's 'result' is set to what parser->parse(data) returned, the same as parsing each
+ * entry on its own.
+ *
+ * @param batch The parsers and their data.
+ */
+template<typename parser_type>
+auto parse_batch(std::span<batch_entry<parser_type>> batch) -> void
+{
+    const std::size_t count = batch.size();
+
+    for(std::size_t i = 0; i < count && i < batch_prefetch_distance; ++i)
+    {
+        batch_prefetch(batch[i].data);
+    }
+
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        if(i + batch_prefetch_distance < count)
+        {
+            batch_prefetch(batch[i + batch_prefetch_distance].data);
+        }
+        auto& entry = batch[i];
+        entry.result = entry.parser->parse(entry.data);
+    }
+}
+
+} // namespace turbo::http
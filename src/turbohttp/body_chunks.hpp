@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace turbo::http
+{
+
+/**
+ * A view of a chunked body that was parsed read-only and could not be decoded in place.
+ * Iterating yields the data of each chunk without the chunk size lines and the trailing \r\n.
+ * The framing has already been validated by the parser, iteration simply ends at the last
+ * (zero length) chunk or at the end of the view.
+ */
+class body_chunks
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+        explicit iterator(std::string_view remaining)
+            : m_remaining(remaining)
+        {
+            next();
+        }
+
+        auto operator*() const -> reference { return m_chunk; }
+        auto operator->() const -> pointer { return &m_chunk; }
+
+        auto operator++() -> iterator&
+        {
+            next();
+            return *this;
+        }
+
+        auto operator++(int) -> iterator
+        {
+            iterator copy{*this};
+            next();
+            return copy;
+        }
+
+        auto operator==(const iterator& other) const -> bool
+        {
+            return m_chunk.data() == other.m_chunk.data() && m_chunk.length() == other.m_chunk.length();
+        }
+
+        auto operator!=(const iterator& other) const -> bool { return !(*this == other); }
+
+    private:
+        auto next() -> void
+        {
+            std::size_t chunk_length{0};
+            std::from_chars(m_remaining.data(), m_remaining.data() + m_remaining.length(), chunk_length, 16);
+            auto size_end = m_remaining.find("\r\n");
+            if(chunk_length == 0 || size_end == std::string_view::npos || chunk_length > m_remaining.length() - (size_end + 2))
+            {
+                // The end iterator.
+                m_remaining = {};
+                m_chunk = {};
+                return;
+            }
+
+            m_chunk = m_remaining.substr(size_end + 2, chunk_length);
+            m_remaining.remove_prefix(std::min(m_remaining.length(), size_end + 2 + chunk_length + 2));
+        }
+
+        /// The raw chunks after the current chunk.
+        std::string_view m_remaining{};
+        /// The current chunk's data, a default constructed view for the end iterator.
+        std::string_view m_chunk{};
+    };
+
+    body_chunks() = default;
+    explicit body_chunks(std::string_view raw)
+        : m_raw(raw)
+    {
+
+    }
+
+    auto begin() const -> iterator { return iterator{m_raw}; }
+    auto end() const -> iterator { return iterator{}; }
+
+    /**
+     * @return The raw chunked body including the chunk framing.
+     */
+    auto raw() const -> std::string_view { return m_raw; }
+
+    /**
+     * @return True if there is no chunked body, e.g. the body was decoded in place or not chunked.
+     */
+    auto empty() const -> bool { return m_raw.empty(); }
+
+private:
+    /// The raw chunked body, starting at the first chunk size line.
+    std::string_view m_raw{};
+};
+
+} // namespace turbo::http
@@ -0,0 +1,464 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace turbo::http
+{
+
+class buffer_pool;
+
+/**
+ * A receive buffer from a buffer_pool, owned by one connection and returned to its pool when
+ * destroyed.  Data is received into space() and committed, parsed from data(), and once a message
+ * is complete next_message() drops it from the front of the buffer so a keep-alive connection
+ * keeps receiving into the same hot buffer.
+ *
+ * The buffer belongs to its pool's thread: it must be released (or destroyed) on the thread that
+ * acquired it and before its pool is destroyed, for buffer_pool::local() before the thread exits.
+ * The memory is unmapped with the pool and the free lists are not thread safe, so a buffer that
+ * crosses threads or outlives its pool dangles.  Copy a message out, e.g. with clone_into(), to
+ * hand it to another thread.
+ *
+ *     auto n = ::recv(fd, buffer.space().data(), buffer.space().size(), 0);
+ *     buffer.commit(n);
+ *     auto data = buffer.data();
+ *     if(parser.parse(data) == request_parse_result::complete)
+ *     {
+ *         ... handle the request ...
+ *         buffer.next_message(parser);
+ *     }
+ */
+class connection_buffer
+{
+public:
+    connection_buffer() = default;
+    ~connection_buffer() { release(); }
+
+    connection_buffer(const connection_buffer&) = delete;
+    auto operator=(const connection_buffer&) -> connection_buffer& = delete;
+
+    connection_buffer(connection_buffer&& other) noexcept
+        : m_pool(std::exchange(other.m_pool, nullptr)),
+          m_data(std::exchange(other.m_data, nullptr)),
+          m_size(std::exchange(other.m_size, 0)),
+          m_capacity(std::exchange(other.m_capacity, 0))
+    {
+    }
+    auto operator=(connection_buffer&& other) noexcept -> connection_buffer&
+    {
+        if(this != &other)
+        {
+            release();
+            m_pool = std::exchange(other.m_pool, nullptr);
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_capacity = std::exchange(other.m_capacity, 0);
+        }
+        return *this;
+    }
+
+    /**
+     * @return False if the pool could not provide a buffer.
+     */
+    explicit operator bool() const { return m_data != nullptr; }
+
+    /**
+     * @return The received bytes that have not been consumed yet, the data to parse.
+     */
+    auto data() -> std::span<char> { return std::span<char>{m_data, m_size}; }
+    auto data() const -> std::span<const char> { return std::span<const char>{m_data, m_size}; }
+
+    /**
+     * @return The free space after the received bytes to receive into, see commit().
+     */
+    auto space() -> std::span<char> { return std::span<char>{m_data + m_size, m_capacity - m_size}; }
+
+    /**
+     * Appends 'length' bytes received into space() to data().
+     */
+    auto commit(std::size_t length) -> void { m_size += length; }
+
+    /**
+     * Copies 'bytes' into space() and commits them.
+     * @return False if they do not fit, nothing is appended.
+     */
+    auto append(std::string_view bytes) -> bool
+    {
+        if(bytes.length() > m_capacity - m_size)
+        {
+            return false;
+        }
+        std::memcpy(m_data + m_size, bytes.data(), bytes.length());
+        m_size += bytes.length();
+        return true;
+    }
+
+    auto size() const -> std::size_t { return m_size; }
+    auto capacity() const -> std::size_t { return m_capacity; }
+
+    /**
+     * Drops the first 'consumed' bytes, the rest (e.g. a pipelined message) is moved to the front.
+     */
+    auto compact(std::size_t consumed) -> void
+    {
+        if(consumed >= m_size)
+        {
+            m_size = 0;
+            return;
+        }
+        std::memmove(m_data, m_data + consumed, m_size - consumed);
+        m_size -= consumed;
+    }
+
+    /**
+     * Drops the message 'parser' just completed and resets the parser for the next message on
+     * the connection, any pipelined bytes already received stay in data().
+     * @param parser A request or response that returned complete for data().
+     */
+    template<typename parser_type>
+    auto next_message(parser_type& parser) -> void
+    {
+        compact(parser.bytes_consumed());
+        parser.reset();
+    }
+
+    /**
+     * Returns the buffer to its pool, the buffer is empty afterwards.
+     */
+    auto release() -> void;
+
+private:
+    friend class buffer_pool;
+
+    connection_buffer(buffer_pool* pool, char* data, std::size_t capacity)
+        : m_pool(pool),
+          m_data(data),
+          m_capacity(capacity)
+    {
+    }
+
+    /// The pool the buffer is returned to.
+    buffer_pool* m_pool{nullptr};
+    /// The start of the buffer.
+    char* m_data{nullptr};
+    /// The bytes received and not consumed yet.
+    std::size_t m_size{0};
+    /// The size class of the buffer.
+    std::size_t m_capacity{0};
+};
+
+/**
+ * How a buffer_pool got its memory, see buffer_pool::stats().
+ */
+struct buffer_pool_stats
+{
+    /// Slabs mapped.
+    std::size_t slabs{0};
+    /// Slabs backed by explicit 2 MB hugepages, the rest use normal (or transparent huge) pages.
+    std::size_t hugepage_slabs{0};
+    /// Buffers handed out by acquire().
+    std::uint64_t acquired{0};
+    /// Buffers handed out by acquire() from a free list instead of carved from a slab.
+    std::uint64_t recycled{0};
+};
+
+/**
+ * Receive buffers for many connections carved from 2 MB slabs, so thousands of connection
+ * buffers are covered by a few TLB entries instead of one per 4 KB page.  Each slab is mapped with
+ * MAP_HUGETLB first and falls back to normal pages (with MADV_HUGEPAGE so transparent hugepages
+ * can still back it) when no hugepages are reserved, or to the heap on platforms without mmap.
+ *
+ * Buffers come in size_classes, a request is rounded up to the smallest class that fits.  A
+ * released buffer goes on the free list of its class and the most recently released buffer is
+ * handed out first since it is the most likely to still be cached.  The pool is not thread safe,
+ * use one per thread, e.g. local(), and release each buffer on the thread that acquired it.
+ * Slabs are only returned to the system when the pool is destroyed.
+ */
+class buffer_pool
+{
+public:
+    /// The size of each slab.
+    static constexpr std::size_t slab_size{2 * 1024 * 1024};
+    /// The buffer sizes handed out.
+    static constexpr std::array<std::size_t, 5> size_classes{4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024};
+
+    /**
+     * @param hugepages Try MAP_HUGETLB for each slab before falling back to normal pages.
+     */
+    explicit buffer_pool(bool hugepages = true)
+        : m_hugepages(hugepages)
+    {
+    }
+    ~buffer_pool()
+    {
+        for(auto& slab : m_slabs)
+        {
+            unmap(slab);
+        }
+    }
+
+    // Buffers point back at their pool.
+    buffer_pool(const buffer_pool&) = delete;
+    buffer_pool(buffer_pool&&) = delete;
+    auto operator=(const buffer_pool&) -> buffer_pool& = delete;
+    auto operator=(buffer_pool&&) -> buffer_pool& = delete;
+
+    /**
+     * @return This thread's pool, destroyed when the thread exits.  Every buffer acquired from it
+     *         has to be released on this thread before then, see connection_buffer.
+     */
+    static auto local() -> buffer_pool&
+    {
+        thread_local buffer_pool pool{};
+        return pool;
+    }
+
+    /**
+     * @param size The bytes the connection needs, e.g. the policy's max_header_bytes.
+     * @return A buffer of the smallest size class of at least 'size' bytes, an empty buffer if
+     *         'size' is larger than the largest class or no memory could be mapped.
+     */
+    auto acquire(std::size_t size) -> connection_buffer
+    {
+        std::size_t index = 0;
+        while(index < size_classes.size() && size_classes[index] < size)
+        {
+            ++index;
+        }
+        if(index == size_classes.size())
+        {
+            return connection_buffer{};
+        }
+
+        char* data = pop(index);
+        if(data != nullptr)
+        {
+            ++m_stats.recycled;
+        }
+        else
+        {
+            data = carve(size_classes[index]);
+            if(data == nullptr)
+            {
+                return connection_buffer{};
+            }
+        }
+        ++m_stats.acquired;
+        return connection_buffer{this, data, size_classes[index]};
+    }
+
+    /**
+     * Moves the buffer into a buffer of at least 'size' bytes, the received bytes are kept.
+     * @return False if there is no larger buffer, the buffer is unchanged.
+     */
+    auto grow(connection_buffer& buffer, std::size_t size) -> bool
+    {
+        auto larger = acquire(size);
+        if(!larger || larger.capacity() <= buffer.capacity())
+        {
+            return false;
+        }
+        larger.append(std::string_view{buffer.data().data(), buffer.size()});
+        buffer = std::move(larger);
+        return true;
+    }
+
+    /**
+     * grow() for a buffer 'parser' is part way through, the parser's views are moved into the
+     * new buffer with attach() so parsing continues where it left off.  False as well if the
+     * parser's state can not be detached, see request::detach().
+     */
+    template<typename parser_type>
+    auto grow(connection_buffer& buffer, std::size_t size, parser_type& parser) -> bool
+    {
+        auto state = parser.detach();
+        if(!state.has_value() || !grow(buffer, size))
+        {
+            return false;
+        }
+        parser.attach(state.value(), buffer.data());
+        return true;
+    }
+
+    auto stats() const -> const buffer_pool_stats& { return m_stats; }
+
+private:
+    friend class connection_buffer;
+
+    /// A free buffer, the link is stored in the buffer itself.
+    struct free_buffer
+    {
+        free_buffer* next;
+    };
+
+    struct slab
+    {
+        void* data;
+        bool mapped;
+    };
+
+    auto push(char* data, std::size_t capacity) -> void
+    {
+        std::size_t index = 0;
+        while(size_classes[index] != capacity)
+        {
+            ++index;
+        }
+        auto* buffer = ::new(data) free_buffer{m_free[index]};
+        m_free[index] = buffer;
+    }
+
+    auto pop(std::size_t index) -> char*
+    {
+        auto* buffer = m_free[index];
+        if(buffer == nullptr)
+        {
+            return nullptr;
+        }
+        m_free[index] = buffer->next;
+        return reinterpret_cast<char*>(buffer);
+    }
+
+    /**
+     * @return 'size' bytes from the current slab, a new slab is mapped if it does not fit.
+     */
+    auto carve(std::size_t size) -> char*
+    {
+        if(size > m_slab_remaining)
+        {
+            // Grow the slab list before anything is changed so recording the new slab can not
+            // throw after it is mapped and the rest of the current slab is handed out.
+            if(m_slabs.size() == m_slabs.capacity())
+            {
+                m_slabs.reserve(m_slabs.empty() ? 8 : m_slabs.size() * 2);
+            }
+
+            // Hand the rest of the slab out to the free lists of the smaller classes.
+            for(std::size_t index = size_classes.size(); index-- > 0;)
+            {
+                while(size_classes[index] <= m_slab_remaining)
+                {
+                    push(m_slab_cursor, size_classes[index]);
+                    m_slab_cursor += size_classes[index];
+                    m_slab_remaining -= size_classes[index];
+                }
+            }
+
+            auto new_slab = map();
+            if(new_slab.data == nullptr)
+            {
+                return nullptr;
+            }
+            m_slabs.push_back(new_slab);
+            m_slab_cursor = static_cast<char*>(new_slab.data);
+            m_slab_remaining = slab_size;
+        }
+
+        char* data = m_slab_cursor;
+        m_slab_cursor += size;
+        m_slab_remaining -= size;
+        return data;
+    }
+
+    auto map() -> slab
+    {
+#if defined(__linux__)
+        constexpr int protection = PROT_READ | PROT_WRITE;
+        constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB)
+        if(m_hugepages)
+        {
+            void* data = ::mmap(nullptr, slab_size, protection, flags | MAP_HUGETLB, -1, 0);
+            if(data != MAP_FAILED)
+            {
+                ++m_stats.slabs;
+                ++m_stats.hugepage_slabs;
+                return slab{data, true};
+            }
+        }
+#endif
+        // Over map by a slab so a 2 MB aligned slab can be trimmed out of it, transparent
+        // hugepages can only back aligned 2 MB ranges.
+        void* mapping = ::mmap(nullptr, slab_size * 2, protection, flags, -1, 0);
+        if(mapping != MAP_FAILED)
+        {
+            auto address = reinterpret_cast<std::uintptr_t>(mapping);
+            auto aligned = (address + slab_size - 1) & ~(static_cast<std::uintptr_t>(slab_size) - 1);
+            if(aligned > address)
+            {
+                ::munmap(mapping, aligned - address);
+            }
+            if(aligned + slab_size < address + slab_size * 2)
+            {
+                ::munmap(reinterpret_cast<void*>(aligned + slab_size), address + slab_size * 2 - (aligned + slab_size));
+            }
+            void* data = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+            if(m_hugepages)
+            {
+                ::madvise(data, slab_size, MADV_HUGEPAGE);
+            }
+#endif
+            ++m_stats.slabs;
+            return slab{data, true};
+        }
+        return slab{nullptr, false};
+#else
+        void* data = ::operator new(slab_size, std::align_val_t{slab_size}, std::nothrow);
+        if(data != nullptr)
+        {
+            ++m_stats.slabs;
+        }
+        return slab{data, false};
+#endif
+    }
+
+    static auto unmap(const slab& s) -> void
+    {
+#if defined(__linux__)
+        if(s.mapped)
+        {
+            ::munmap(s.data, slab_size);
+            return;
+        }
+#endif
+        ::operator delete(s.data, std::align_val_t{slab_size});
+    }
+
+    /// Try MAP_HUGETLB first?
+    bool m_hugepages{true};
+    /// The most recently released buffer of each size class.
+    std::array<free_buffer*, size_classes.size()> m_free{};
+    /// Every slab mapped, returned to the system when the pool is destroyed.
+    std::vector<slab> m_slabs{};
+    /// The part of the newest slab that has not been carved yet.
+    char* m_slab_cursor{nullptr};
+    std::size_t m_slab_remaining{0};
+    buffer_pool_stats m_stats{};
+};
+
+inline auto connection_buffer::release() -> void
+{
+    if(m_pool != nullptr)
+    {
+        m_pool->push(m_data, m_capacity);
+    }
+    m_pool = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+    m_capacity = 0;
+}
+
+} // namespace turbo::http
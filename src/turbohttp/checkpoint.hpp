@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace turbo::http
+{
+
+/// The version of the checkpoint blob layout, restore() rejects blobs of any other version.
+inline constexpr std::uint8_t checkpoint_format_version{1};
+
+/**
+ * The layout of the blob written by request::checkpoint() and response::checkpoint().  All
+ * values are little endian so the blob does not depend on the compiler, the build or the
+ * parser's policy and can be handed to another thread or process.  The header names and values
+ * are stored as offsets so restoring does not scan the headers again.
+ */
+namespace checkpoint_layout
+{
+
+// The offset of each field, followed by its size in bytes.
+inline constexpr std::size_t magic{0};            // 4 "THCP"
+inline constexpr std::size_t format{4};           // 1 checkpoint_format_version
+inline constexpr std::size_t kind{5};             // 1 0 for a request, 1 for a response
+inline constexpr std::size_t parse_state{6};      // 1
+inline constexpr std::size_t version{7};          // 1
+inline constexpr std::size_t body_type{8};        // 1
+inline constexpr std::size_t method{9};           // 1 request
+inline constexpr std::size_t status_code{10};     // 2 response
+inline constexpr std::size_t pos{12};             // 4
+inline constexpr std::size_t uri_start{16};       // 4 request
+inline constexpr std::size_t line_length{20};     // 4 uri length or reason phrase length
+inline constexpr std::size_t headers_start{24};   // 4
+inline constexpr std::size_t body_start{28};      // 4
+inline constexpr std::size_t content_length{32};  // 8 Content-Length or decoded chunked length
+inline constexpr std::size_t header_count{40};    // 2
+inline constexpr std::size_t flags{42};           // 2
+inline constexpr std::size_t hash{44};            // 4 blob_hash() of the blob
+inline constexpr std::size_t headers{48};         // header_count entries
+
+/// The size of the blob without any header entries.
+inline constexpr std::size_t size{48};
+
+// Each header entry.
+inline constexpr std::size_t name_start{0};       // 4
+inline constexpr std::size_t name_length{4};      // 2
+inline constexpr std::size_t value_offset{6};     // 2 from the start of the name
+inline constexpr std::size_t value_length{8};     // 4
+inline constexpr std::size_t entry_size{12};
+
+/// The header entries did not fit, restore() splits the header lines again instead.
+inline constexpr std::uint16_t flag_split_headers{1};
+
+inline constexpr std::array<std::byte, 4> magic_bytes{std::byte{'T'}, std::byte{'H'}, std::byte{'C'}, std::byte{'P'}};
+
+inline constexpr std::uint8_t kind_request{0};
+inline constexpr std::uint8_t kind_response{1};
+
+template<typename value_type>
+auto store(std::span<std::byte> blob, std::size_t offset, value_type value) -> void
+{
+    for(std::size_t i = 0; i < sizeof(value_type); ++i)
+    {
+        blob[offset + i] = static_cast<std::byte>(static_cast<std::uint64_t>(value) >> (i * 8));
+    }
+}
+
+template<typename value_type>
+auto load(std::span<const std::byte> blob, std::size_t offset) -> value_type
+{
+    std::uint64_t value{0};
+    for(std::size_t i = 0; i < sizeof(value_type); ++i)
+    {
+        value |= static_cast<std::uint64_t>(blob[offset + i]) << (i * 8);
+    }
+    return static_cast<value_type>(value);
+}
+
+/**
+ * @return The FNV-1a hash of the blob's 8 byte little endian words, the hash field reads as 0.
+ */
+inline auto blob_hash(std::span<const std::byte> blob) -> std::uint32_t
+{
+    static_assert(hash % 8 == 4);
+
+    std::uint64_t h{14695981039346656037ull};
+    std::size_t i = 0;
+    for(; i + 8 <= blob.size(); i += 8)
+    {
+        auto word = load<std::uint64_t>(blob, i);
+        if(i + 4 == hash)
+        {
+            word &= 0xFFFFFFFFull;
+        }
+        h = (h ^ word) * 1099511628211ull;
+    }
+    if(i < blob.size())
+    {
+        // Every blob is a multiple of 4 bytes.
+        h = (h ^ load<std::uint32_t>(blob, i)) * 1099511628211ull;
+    }
+    return static_cast<std::uint32_t>(h ^ (h >> 32));
+}
+
+} // namespace checkpoint_layout
+
+} // namespace turbo::http
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "turbohttp/buffer_pool.hpp"
+#include "turbohttp/parser.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <utility>
+
+namespace turbo::http
+{
+
+/**
+ * The receive loop of one keep-alive connection: the received bytes are appended to a
+ * connection_buffer and parsed in place, every complete message is handed out by next() without
+ * copying it and the bytes after it (pipelined messages) are parsed next.
+ *
+ *     connection_parser<request<>> connection{};
+ *     ...
+ *     auto space = connection.space();
+ *     connection.commit(::recv(fd, space.data(), space.size(), 0));
+ *     for(auto& request : connection)
+ *     {
+ *         ... handle the request ...
+ *     }
+ *     if(connection.error()) { ... close the connection ... }
+ *
+ * Consumed bytes are only dropped from the buffer when space() needs room for more, and never
+ * while a complete message handed out by next() is still in use, so the views of that message
+ * stay valid until next() is called again.  When space() does compact the buffer a partially
+ * parsed message is moved to the front and its views are rebased with detach() and attach()
+ * rather than parsed again.  When the connection goes idle between messages the buffer is
+ * emptied without moving anything.
+ *
+ * @tparam parser_type A request or response.
+ */
+template<typename parser_type = request<>>
+class connection_parser
+{
+public:
+    using result_type = decltype(std::declval<parser_type&>().parse(std::declval<std::span<char>&>()));
+
+    /**
+     * @param buffer_size The size of the receive buffer taken from buffer_pool::local(), the
+     *                    largest message the connection can receive.
+     */
+    explicit connection_parser(std::size_t buffer_size = 16 * 1024)
+        : connection_parser(buffer_pool::local().acquire(buffer_size))
+    {
+    }
+
+    /**
+     * @param buffer The receive buffer to use, e.g. from a buffer_pool.
+     */
+    explicit connection_parser(connection_buffer buffer)
+        : m_buffer(std::move(buffer))
+    {
+    }
+
+    ~connection_parser() = default;
+
+    // The parser's views point into the buffer.
+    connection_parser(const connection_parser&) = delete;
+    connection_parser(connection_parser&&) = delete;
+    auto operator=(const connection_parser&) -> connection_parser& = delete;
+    auto operator=(connection_parser&&) -> connection_parser& = delete;
+
+    /**
+     * @param wanted The free bytes wanted, the buffer is compacted if fewer are free.
+     * @return The free space to receive into, see commit().  Smaller than 'wanted' if the buffer
+     *         is full of unconsumed bytes or holds the message last returned by next(), empty if
+     *         the message being received does not fit in the buffer.
+     */
+    auto space(std::size_t wanted = 1) -> std::span<char>
+    {
+        if(m_buffer.space().size() < wanted && m_start > 0 && !m_complete)
+        {
+            compact();
+        }
+        return m_buffer.space();
+    }
+
+    /**
+     * Appends 'length' bytes received into space().
+     */
+    auto commit(std::size_t length) -> void { m_buffer.commit(length); }
+
+    /**
+     * Copies 'bytes' into space() and commits them.
+     * @return False if they do not fit, nothing is appended.
+     */
+    auto append(std::string_view bytes) -> bool
+    {
+        space(bytes.length());
+        return m_buffer.append(bytes);
+    }
+
+    /**
+     * Drops the message returned by the previous call, if any, and parses the next one.
+     * @return The parser holding the next complete message, nullptr if more data is needed or
+     *         the data is malformed, see result().  Valid until next() is called again.
+     */
+    auto next() -> parser_type*
+    {
+        if(m_complete)
+        {
+            m_start += m_parser.bytes_consumed();
+            m_parser.reset();
+            m_complete = false;
+            if(m_start == m_buffer.size())
+            {
+                // Nothing pipelined, start receiving at the front again without moving anything.
+                m_buffer.compact(m_start);
+                m_start = 0;
+            }
+        }
+        if(error())
+        {
+            return nullptr;
+        }
+
+        auto data = m_buffer.data().subspan(m_start);
+        m_result = m_parser.parse(data);
+        if(m_result == result_type::complete)
+        {
+            m_complete = true;
+            return &m_parser;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @return The result of the last parse.
+     */
+    auto result() const -> result_type { return m_result; }
+
+    /**
+     * @return True if the data is malformed and the connection should be closed.
+     */
+    auto error() const -> bool
+    {
+        return m_result != result_type::complete && m_result != result_type::incomplete;
+    }
+
+    /**
+     * @return The bytes received and not consumed by a complete message yet.
+     */
+    auto pending() const -> std::size_t { return m_buffer.size() - m_start; }
+
+    auto parser() -> parser_type& { return m_parser; }
+
+    /**
+     * Iterates the complete messages received so far by calling next(), see the example above.
+     */
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = parser_type;
+
+        iterator() = default;
+
+        auto operator*() const -> parser_type& { return *m_current; }
+        auto operator->() const -> parser_type* { return m_current; }
+        auto operator++() -> iterator&
+        {
+            m_current = m_connection->next();
+            return *this;
+        }
+        auto operator++(int) -> iterator
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+        auto operator==(std::default_sentinel_t) const -> bool { return m_current == nullptr; }
+
+    private:
+        friend class connection_parser;
+
+        iterator(connection_parser* connection, parser_type* current)
+            : m_connection(connection),
+              m_current(current)
+        {
+        }
+
+        connection_parser* m_connection{nullptr};
+        parser_type* m_current{nullptr};
+    };
+
+    auto begin() -> iterator { return iterator{this, next()}; }
+    auto end() const -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+    /**
+     * Moves the unconsumed bytes to the front of the buffer, unless the parser's state can not
+     * be detached, see request::detach().
+     */
+    auto compact() -> void
+    {
+        auto state = m_parser.detach();
+        if(!state.has_value())
+        {
+            return;
+        }
+        m_buffer.compact(m_start);
+        m_start = 0;
+        m_parser.attach(state.value(), m_buffer.data());
+    }
+
+    /// The received bytes.
+    connection_buffer m_buffer;
+    /// The start of the message being parsed in 'm_buffer'.
+    std::size_t m_start{0};
+    parser_type m_parser{};
+    result_type m_result{result_type::incomplete};
+    /// Is 'm_parser' holding a complete message returned by next()?
+    bool m_complete{false};
+};
+
+} // namespace turbo::http
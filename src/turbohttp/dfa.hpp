@@ -0,0 +1,423 @@
+#pragma once
+
+#include "turbohttp/method.hpp"
+#include "turbohttp/scan.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace turbo::http
+{
+
+/**
+ * The tables of the DFA engine (dispatch_engine::dfa) which parses the request line or status
+ * line and the header fields one byte at a time.  Every byte is mapped to a character class and
+ * the next state is a single lookup in a dense [state][class] table, so the cost per byte is the
+ * same no matter what the byte is.  The tables are generated at compile time from the grammar in
+ * make_dfa_tables() for the lenient and strict policies, the strict tables only accept the RFC
+ * 9112 characters so validation happens in the same pass.
+ *
+ * Entering a state can trigger an action (see dfa_action), e.g. entering the state after the
+ * method's HTTP_SP records the method.  Anything else about the message is known from the state
+ * alone.  Bodies (including the chunk framing) are skipped by their length so they are left to
+ * parse_body_common().
+ */
+
+/// The methods recognized by the request line, each one is a path through the method states.
+inline constexpr std::array<std::pair<std::string_view, method>, 9> dfa_methods{{
+    {"GET", method::get},
+    {"HEAD", method::head},
+    {"POST", method::post},
+    {"PUT", method::put},
+    {"DELETE", method::http_delete},
+    {"CONNECT", method::connect},
+    {"OPTIONS", method::options},
+    {"TRACE", method::trace},
+    {"PATCH", method::patch}
+}};
+
+/// The bytes with a character class of their own: the letters of the methods, "HTTP/1." and the minor versions.
+inline constexpr std::string_view dfa_literal_chars = "ACDEGHILNOPRSTU/.01";
+
+namespace dfa_class
+{
+    inline constexpr std::uint8_t sp      = 0;
+    inline constexpr std::uint8_t htab    = 1;
+    inline constexpr std::uint8_t cr      = 2;
+    inline constexpr std::uint8_t lf      = 3;
+    inline constexpr std::uint8_t colon   = 4;
+    /// '2' through '9', '0' and '1' are literals.
+    inline constexpr std::uint8_t digit   = 5;
+    /// The class of dfa_literal_chars[0], the others follow in order.
+    inline constexpr std::uint8_t literal = 6;
+    /// The class of every other byte is 'other' plus its dfa_member bits.
+    inline constexpr std::uint8_t other   = literal + dfa_literal_chars.size();
+    inline constexpr std::size_t count    = other + 8;
+} // namespace dfa_class
+
+/// The character sets a class belongs to, used to generate the transitions.
+namespace dfa_member
+{
+    /// A header name (tchar) character.
+    inline constexpr std::uint8_t tchar = 1;
+    /// A strict uri character.
+    inline constexpr std::uint8_t uri   = 2;
+    /// A strict header value character, including SP, HTAB and obs-text.
+    inline constexpr std::uint8_t field = 4;
+} // namespace dfa_member
+
+constexpr auto dfa_members(unsigned char c) -> std::uint8_t
+{
+    if(c >= 0x80)
+    {
+        return dfa_member::field; // obs-text
+    }
+    std::uint8_t members{0};
+    members |= tchar_class.table[c] ? dfa_member::tchar : 0;
+    members |= uri_class.table[c] ? dfa_member::uri : 0;
+    members |= field_invalid_class.table[c] ? 0 : dfa_member::field;
+    return members;
+}
+
+/// The character class of every byte.
+inline constexpr std::array<std::uint8_t, 256> dfa_class_table = []() {
+    std::array<std::uint8_t, 256> table{};
+    for(unsigned int c = 0; c < 256; ++c)
+    {
+        auto ch = static_cast<unsigned char>(c);
+        auto literal = dfa_literal_chars.find(static_cast<char>(ch));
+        if(ch == ' ')                               table[c] = dfa_class::sp;
+        else if(ch == '\t')                         table[c] = dfa_class::htab;
+        else if(ch == '\r')                         table[c] = dfa_class::cr;
+        else if(ch == '\n')                         table[c] = dfa_class::lf;
+        else if(ch == ':')                          table[c] = dfa_class::colon;
+        else if(ch >= '2' && ch <= '9')             table[c] = dfa_class::digit;
+        else if(literal != std::string_view::npos)  table[c] = static_cast<std::uint8_t>(dfa_class::literal + literal);
+        else                                        table[c] = static_cast<std::uint8_t>(dfa_class::other + dfa_members(ch));
+    }
+    return table;
+}();
+
+/// The character sets of every class.
+inline constexpr std::array<std::uint8_t, dfa_class::count> dfa_class_members = []() {
+    std::array<std::uint8_t, dfa_class::count> members{};
+    for(unsigned int c = 0; c < 256; ++c)
+    {
+        members[dfa_class_table[c]] = dfa_members(static_cast<unsigned char>(c));
+    }
+    return members;
+}();
+
+/**
+ * @return The number of states needed to recognize dfa_methods, one per distinct prefix.
+ */
+constexpr auto dfa_method_state_count() -> std::size_t
+{
+    std::size_t count{0};
+    for(std::size_t i = 0; i < dfa_methods.size(); ++i)
+    {
+        for(std::size_t length = 1; length <= dfa_methods[i].first.length(); ++length)
+        {
+            auto prefix = dfa_methods[i].first.substr(0, length);
+            bool seen = false;
+            for(std::size_t j = 0; j < i; ++j)
+            {
+                seen = seen || dfa_methods[j].first.starts_with(prefix);
+            }
+            count += seen ? 0 : 1;
+        }
+    }
+    return count;
+}
+
+namespace dfa_state
+{
+    // Errors, every transition out of an error leads back to it.
+    inline constexpr std::uint8_t error_method            = 0;
+    inline constexpr std::uint8_t error_uri               = 1;
+    inline constexpr std::uint8_t error_version_malformed = 2;
+    inline constexpr std::uint8_t error_version_unknown   = 3;
+    inline constexpr std::uint8_t error_status_code       = 4;
+    inline constexpr std::uint8_t error_header            = 5;
+
+    // Request line.
+    inline constexpr std::uint8_t uri_start        = 6;
+    inline constexpr std::uint8_t uri              = 7;
+    /// "HTTP/1." one state per character and then the states after the minor versions 0 and 1.
+    inline constexpr std::uint8_t request_version  = 8;
+    inline constexpr std::uint8_t request_cr       = request_version + 10;
+
+    // Status line.
+    inline constexpr std::uint8_t response_version = request_cr + 1;
+    inline constexpr std::uint8_t status_code      = response_version + 10;
+    inline constexpr std::uint8_t status_code_end  = status_code + 3;
+    inline constexpr std::uint8_t reason_start     = status_code_end + 1;
+    inline constexpr std::uint8_t reason           = reason_start + 1;
+    inline constexpr std::uint8_t reason_cr        = reason + 1;
+
+    // Header fields, every state from line_start to head_cr starts a line or is inside of one.
+    inline constexpr std::uint8_t line_start       = reason_cr + 1;
+    inline constexpr std::uint8_t request_line_end = line_start + 1;
+    inline constexpr std::uint8_t status_line_end  = line_start + 2;
+    inline constexpr std::uint8_t header_end       = line_start + 3;
+    inline constexpr std::uint8_t name             = line_start + 4;
+    inline constexpr std::uint8_t colon            = line_start + 5;
+    inline constexpr std::uint8_t value_ws         = line_start + 6;
+    inline constexpr std::uint8_t value            = line_start + 7;
+    inline constexpr std::uint8_t value_cr         = line_start + 8;
+    inline constexpr std::uint8_t head_cr          = line_start + 9;
+    inline constexpr std::uint8_t head_end         = head_cr + 1;
+
+    /// The start of the request line, the method states follow.
+    inline constexpr std::uint8_t method           = head_end + 1;
+
+    inline constexpr std::size_t count = method + 1 + dfa_method_state_count();
+} // namespace dfa_state
+
+static_assert(dfa_state::count <= 256, "The DFA states must fit in a byte.");
+
+namespace dfa_action
+{
+    inline constexpr std::uint8_t none             = 0;
+    inline constexpr std::uint8_t error            = 1;
+    /// The method is known from the previous state.
+    inline constexpr std::uint8_t method           = 2;
+    inline constexpr std::uint8_t uri              = 3;
+    inline constexpr std::uint8_t version_1_0      = 4;
+    inline constexpr std::uint8_t version_1_1      = 5;
+    inline constexpr std::uint8_t request_line     = 6;
+    inline constexpr std::uint8_t response_version = 7;
+    inline constexpr std::uint8_t status_code      = 8;
+    inline constexpr std::uint8_t status_line      = 9;
+    inline constexpr std::uint8_t colon            = 10;
+    inline constexpr std::uint8_t value_ws         = 11;
+    inline constexpr std::uint8_t header           = 12;
+    inline constexpr std::uint8_t head_end         = 13;
+} // namespace dfa_action
+
+struct dfa_tables
+{
+    /// The next state, indexed by the current state and the class of the byte.
+    std::array<std::array<std::uint8_t, dfa_class::count>, dfa_state::count> next{};
+    /// The action taken when a state is entered.
+    std::array<std::uint8_t, dfa_state::count> action{};
+    /// The method of the method states that can be followed by HTTP_SP.
+    std::array<method, dfa_state::count> method_of{};
+};
+
+/**
+ * Generates the tables from the grammar.
+ * @tparam strict Only accept the RFC 9112 characters, see strict_policy.  Otherwise only the
+ *                framing characters are checked, see lenient_policy.
+ */
+template<bool strict>
+constexpr auto make_dfa_tables() -> dfa_tables
+{
+    namespace s = dfa_state;
+    namespace c = dfa_class;
+
+    dfa_tables t{};
+
+    auto fill = [&t](std::uint8_t state, std::uint8_t next) {
+        t.next[state].fill(next);
+    };
+    auto fill_members = [&t](std::uint8_t state, std::uint8_t members, std::uint8_t next) {
+        for(std::size_t cls = 0; cls < c::count; ++cls)
+        {
+            if((dfa_class_members[cls] & members) != 0)
+            {
+                t.next[state][cls] = next;
+            }
+        }
+    };
+    auto literal = [](char ch) -> std::size_t {
+        return c::literal + dfa_literal_chars.find(ch);
+    };
+
+    for(std::uint8_t state = s::error_method; state <= s::error_header; ++state)
+    {
+        fill(state, state);
+        t.action[state] = dfa_action::error;
+    }
+
+    // Method, each method is a path of literal characters from 'method' followed by HTTP_SP.
+    fill(s::method, s::error_method);
+    auto next_state = static_cast<std::uint8_t>(s::method + 1);
+    for(const auto& [name, m] : dfa_methods)
+    {
+        std::uint8_t state = s::method;
+        for(char ch : name)
+        {
+            if(t.next[state][literal(ch)] == s::error_method)
+            {
+                fill(next_state, s::error_method);
+                t.next[state][literal(ch)] = next_state++;
+            }
+            state = t.next[state][literal(ch)];
+        }
+        t.next[state][c::sp] = s::uri_start;
+        t.method_of[state] = m;
+    }
+    t.action[s::uri_start] = dfa_action::method;
+
+    // Uri, everything up to HTTP_SP.  The strict uri is at least one uri character, the lenient
+    // uri is any bytes including none, the same as parse_uri_common().
+    for(auto state : {s::uri_start, s::uri})
+    {
+        if constexpr(strict)
+        {
+            fill(state, s::error_uri);
+            fill_members(state, dfa_member::uri, s::uri);
+        }
+        else
+        {
+            fill(state, s::uri);
+        }
+        t.next[state][c::sp] = s::request_version;
+    }
+    if constexpr(strict)
+    {
+        t.next[s::uri_start][c::sp] = s::error_uri;
+    }
+    t.action[s::request_version] = dfa_action::uri;
+
+    // "HTTP/1.0" or "HTTP/1.1", a major version other than 1 or an unknown minor version is unknown.
+    auto version = [&](std::uint8_t first) {
+        constexpr std::string_view expected = "HTTP/1.";
+        for(std::uint8_t i = 0; i < expected.length(); ++i)
+        {
+            fill(first + i, (expected[i] == '1') ? s::error_version_unknown : s::error_version_malformed);
+            t.next[first + i][literal(expected[i])] = static_cast<std::uint8_t>(first + i + 1);
+        }
+        auto minor = static_cast<std::uint8_t>(first + expected.length());
+        fill(minor, s::error_version_unknown);
+        t.next[minor][literal('0')] = static_cast<std::uint8_t>(minor + 1);
+        t.next[minor][literal('1')] = static_cast<std::uint8_t>(minor + 2);
+        fill(minor + 1, s::error_version_malformed);
+        fill(minor + 2, s::error_version_malformed);
+        t.action[minor + 1] = dfa_action::version_1_0;
+        t.action[minor + 2] = dfa_action::version_1_1;
+        return std::pair{static_cast<std::uint8_t>(minor + 1), static_cast<std::uint8_t>(minor + 2)};
+    };
+
+    // The request line ends with the version's \r\n.
+    auto [request_1_0, request_1_1] = version(s::request_version);
+    t.next[request_1_0][c::cr] = t.next[request_1_1][c::cr] = s::request_cr;
+    fill(s::request_cr, s::error_version_malformed);
+    t.next[s::request_cr][c::lf] = s::request_line_end;
+    t.action[s::request_line_end] = dfa_action::request_line;
+
+    // Status line, "HTTP/1.x XXX reason\r\n".
+    auto [response_1_0, response_1_1] = version(s::response_version);
+    t.next[response_1_0][c::sp] = t.next[response_1_1][c::sp] = s::status_code;
+    t.action[s::status_code] = dfa_action::response_version;
+    for(std::uint8_t state = s::status_code; state < s::status_code_end; ++state)
+    {
+        fill(state, s::error_status_code);
+        for(auto cls : {static_cast<std::size_t>(c::digit), literal('0'), literal('1')})
+        {
+            t.next[state][cls] = static_cast<std::uint8_t>(state + 1);
+        }
+    }
+    fill(s::status_code_end, s::error_status_code);
+    t.next[s::status_code_end][c::sp] = s::reason_start;
+    t.action[s::reason_start] = dfa_action::status_code;
+
+    // The reason phrase is anything up to the \r\n.
+    for(auto state : {s::reason_start, s::reason, s::reason_cr})
+    {
+        fill(state, s::reason);
+        t.next[state][c::cr] = s::reason_cr;
+    }
+    t.next[s::reason_cr][c::lf] = s::status_line_end;
+    t.action[s::status_line_end] = dfa_action::status_line;
+
+    // A header line or the empty line that ends the headers.  The strict tables reject obs-fold
+    // since a continuation line starts with HTTP_SP or HTTP_HTAB.  The lenient name is any bytes
+    // up to the first ':', including none, the same as parse_headers_common().
+    for(auto state : {s::line_start, s::request_line_end, s::status_line_end, s::header_end})
+    {
+        if constexpr(strict)
+        {
+            fill(state, s::error_header);
+            fill_members(state, dfa_member::tchar, s::name);
+        }
+        else
+        {
+            fill(state, s::name);
+            t.next[state][c::colon] = s::colon;
+        }
+        t.next[state][c::cr] = s::head_cr;
+    }
+    t.action[s::header_end] = dfa_action::header;
+
+    // The name is everything up to the ':'.
+    if constexpr(strict)
+    {
+        fill(s::name, s::error_header);
+        fill_members(s::name, dfa_member::tchar, s::name);
+    }
+    else
+    {
+        fill(s::name, s::name);
+    }
+    t.next[s::name][c::colon] = s::colon;
+    t.action[s::colon] = dfa_action::colon;
+
+    // The value without its leading whitespace up to the \r\n.
+    for(auto state : {s::colon, s::value_ws, s::value})
+    {
+        if constexpr(strict)
+        {
+            fill(state, s::error_header);
+            fill_members(state, dfa_member::field, s::value);
+        }
+        else
+        {
+            fill(state, s::value);
+        }
+        t.next[state][c::cr] = s::value_cr;
+    }
+    for(auto state : {s::colon, s::value_ws})
+    {
+        t.next[state][c::sp] = t.next[state][c::htab] = s::value_ws;
+    }
+    t.action[s::value_ws] = dfa_action::value_ws;
+
+    if constexpr(strict)
+    {
+        fill(s::value_cr, s::error_header);
+    }
+    else
+    {
+        // A lone \r is part of the value.
+        fill(s::value_cr, s::value);
+        t.next[s::value_cr][c::cr] = s::value_cr;
+    }
+    t.next[s::value_cr][c::lf] = s::header_end;
+
+    if constexpr(strict)
+    {
+        fill(s::head_cr, s::error_header);
+    }
+    else
+    {
+        // A \r not followed by \n starts a name.
+        fill(s::head_cr, s::name);
+        t.next[s::head_cr][c::colon] = s::colon;
+    }
+    t.next[s::head_cr][c::lf] = s::head_end;
+    fill(s::head_end, s::error_header);
+    t.action[s::head_end] = dfa_action::head_end;
+
+    return t;
+}
+
+/// The DFA tables for the lenient_policy (false) and strict_policy (true).
+template<bool strict>
+inline constexpr dfa_tables dfa_table = make_dfa_tables<strict>();
+
+} // namespace turbo::http
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "turbohttp/parser.hpp"
+
+#include <string>
+#include <span>
+
+namespace turbo::http
+{
+
+/**
+ * A storage free event driven request parser.  Instead of storing the parsed request each part
+ * is handed to the derived handler as soon as it is parsed, the parser keeps no header array
+ * and has no limit on the number of headers.  The handler derives from this class (CRTP) so
+ * the events are resolved at compile time and inline completely.
+ *
+ * The handler can implement any of the following events, events it does not implement use the
+ * no-op defaults below.  Each event returns 'advance' to continue parsing, any other value stops
+ * parsing and is returned from parse().
+ *
+ *     auto on_method(method m) -> request_parse_result;
+ *     auto on_uri(std::string_view uri) -> request_parse_result;
+ *     auto on_version(version v) -> request_parse_result;
+ *     auto on_header(std::string_view name, std::string_view value) -> request_parse_result;
+ *     auto on_headers_complete() -> request_parse_result;
+ *     auto on_body(std::span<char> body) -> request_parse_result;
+ *
+ * A Content-Length body is delivered with a single on_body() once it has fully arrived, a chunked
+ * body is delivered with an on_body() per chunk without the chunk framing, the data is not mutated.
+ *
+ * @tparam derived_type The handler type deriving from this class.
+ * @tparam policy_type The parser policy, see policy.hpp.
+ */
+template<typename derived_type, typename policy_type = lenient_policy>
+class request_event_parser
+{
+public:
+    request_event_parser() = default;
+    ~request_event_parser() = default;
+
+    request_event_parser(const request_event_parser&) = default;
+    request_event_parser(request_event_parser&&) = default;
+    auto operator=(const request_event_parser&) -> request_event_parser& = default;
+    auto operator=(request_event_parser&&) -> request_event_parser& = default;
+
+    /**
+     * A stateful parse function with the same semantics as request::parse().
+     * @param data The full HTTP request data.
+     * @return The current state of parsing the HTTP request data.
+     */
+    auto parse(std::string& data) -> request_parse_result;
+
+    auto parse(std::span<char>& data) -> request_parse_result;
+
+    /**
+     * Resets the parser to parse another request.
+     */
+    auto reset() -> void;
+
+    /**
+     * @return The current internal parse state (how far its gotten) for the current set of data.
+     */
+    auto state() const -> request_parse_state { return m_parse_state; }
+
+    /**
+     * @return Gets the number of headers handed to on_header() so far.
+     */
+    auto http_header_count() const -> std::size_t { return m_header_count; }
+
+    auto on_method(method) -> request_parse_result { return request_parse_result::advance; }
+    auto on_uri(std::string_view) -> request_parse_result { return request_parse_result::advance; }
+    auto on_version(version) -> request_parse_result { return request_parse_result::advance; }
+    auto on_header(std::string_view, std::string_view) -> request_parse_result { return request_parse_result::advance; }
+    auto on_headers_complete() -> request_parse_result { return request_parse_result::advance; }
+    auto on_body(std::span<char>) -> request_parse_result { return request_parse_result::advance; }
+
+private:
+    auto handler() -> derived_type& { return static_cast<derived_type&>(*this); }
+
+    /// How far in the parse state machine has this data gotten?
+    request_parse_state m_parse_state{request_parse_state::start};
+    /// The exact index of where the previous parse() call was left off at.
+    std::size_t m_pos{0};
+    /// The parsed HTTP Method, only kept for the duration of the method stage.
+    method m_method{method::get};
+    /// The starting position of the URI, saved during subsequent parses to calculate the full view.
+    std::size_t m_uri_start_pos{0};
+    /// The parsed URI, only kept for the duration of the uri stage.
+    std::string_view m_uri{};
+    /// The parsed HTTP/X.Y version, only kept for the duration of the version stage.
+    version m_version{version::v1_1};
+    /// The starting position of the headers, used to enforce the policy's max_header_bytes.
+    std::size_t m_headers_start{0};
+    /// The number of headers handed to the handler.
+    std::size_t m_header_count{0};
+    /// The type of body, if there is one.
+    body_type m_body_type{body_type::no_body};
+    /// The Content-Length value if present, otherwise the decoded length of a chunked body.
+    std::size_t m_content_length{0};
+};
+
+/**
+ * A storage free event driven response parser, see request_event_parser.
+ *
+ *     auto on_version(version v) -> response_parse_result;
+ *     auto on_status_code(uint64_t status_code) -> response_parse_result;
+ *     auto on_reason_phrase(std::string_view reason_phrase) -> response_parse_result;
+ *     auto on_header(std::string_view name, std::string_view value) -> response_parse_result;
+ *     auto on_headers_complete() -> response_parse_result;
+ *     auto on_body(std::span<char> body) -> response_parse_result;
+ *
+ * @tparam derived_type The handler type deriving from this class.
+ * @tparam policy_type The parser policy, see policy.hpp.
+ */
+template<typename derived_type, typename policy_type = lenient_policy>
+class response_event_parser
+{
+public:
+    response_event_parser() = default;
+    ~response_event_parser() = default;
+
+    response_event_parser(const response_event_parser&) = default;
+    response_event_parser(response_event_parser&&) = default;
+    auto operator=(const response_event_parser&) -> response_event_parser& = default;
+    auto operator=(response_event_parser&&) -> response_event_parser& = default;
+
+    /**
+     * A stateful parse function with the same semantics as response::parse().
+     * @param data The full HTTP response data.
+     * @return The current state of parsing the HTTP response data.
+     */
+    auto parse(std::string& data) -> response_parse_result;
+
+    auto parse(std::span<char>& data) -> response_parse_result;
+
+    /**
+     * Resets the parser to parse another response.
+     */
+    auto reset() -> void;
+
+    /**
+     * @return The current internal parse state (how far its gotten) for the current set of data.
+     */
+    auto state() const -> response_parse_state { return m_parse_state; }
+
+    /**
+     * @return Gets the number of headers handed to on_header() so far.
+     */
+    auto http_header_count() const -> std::size_t { return m_header_count; }
+
+    auto on_version(version) -> response_parse_result { return response_parse_result::advance; }
+    auto on_status_code(uint64_t) -> response_parse_result { return response_parse_result::advance; }
+    auto on_reason_phrase(std::string_view) -> response_parse_result { return response_parse_result::advance; }
+    auto on_header(std::string_view, std::string_view) -> response_parse_result { return response_parse_result::advance; }
+    auto on_headers_complete() -> response_parse_result { return response_parse_result::advance; }
+    auto on_body(std::span<char>) -> response_parse_result { return response_parse_result::advance; }
+
+private:
+    auto handler() -> derived_type& { return static_cast<derived_type&>(*this); }
+
+    /// How far in the parse state machine has this data gotten?
+    response_parse_state m_parse_state{response_parse_state::start};
+    /// The exact index of where the previous parse() call was left off at.
+    std::size_t m_pos{0};
+    /// The parsed HTTP/X.Y version, only kept for the duration of the version stage.
+    version m_version{version::v1_1};
+    /// The HTTP response status code, only kept for the duration of the status code stage.
+    uint64_t m_status_code{0};
+    /// The HTTP Reason Phrase, only kept for the duration of the reason phrase stage.
+    std::string_view m_reason_phrase{};
+    /// The starting position of the headers, used to enforce the policy's max_header_bytes.
+    std::size_t m_headers_start{0};
+    /// The number of headers handed to the handler.
+    std::size_t m_header_count{0};
+    /// The type of body, if there is one.
+    body_type m_body_type{body_type::no_body};
+    /// The Content-Length value if present, otherwise the decoded length of a chunked body.
+    std::size_t m_content_length{0};
+};
+
+} // namespace turbo::http
+
+#include "turbohttp/event_parser.tcc"
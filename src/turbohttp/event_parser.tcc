@@ -0,0 +1,266 @@
+#pragma once
+
+#include "turbohttp/event_parser.hpp"
+
+namespace turbo::http
+{
+
+template<typename derived_type, typename policy_type>
+auto request_event_parser<derived_type, policy_type>::parse(std::string& data) -> request_parse_result
+{
+    std::span<char> data_span{data.data(), data.length()};
+    return parse(data_span);
+}
+
+template<typename derived_type, typename policy_type>
+auto request_event_parser<derived_type, policy_type>::parse(std::span<char>& data) -> request_parse_result
+{
+    if(data.empty())
+    {
+        return request_parse_result::incomplete;
+    }
+
+    if(m_parse_state == request_parse_state::start)
+    {
+        auto result = parse_method_common(data, m_pos, m_method);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = request_parse_state::parsed_method;
+
+        result = handler().on_method(m_method);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == request_parse_state::parsed_method)
+    {
+        auto result = parse_uri_common<policy_type>(data, m_pos, m_uri_start_pos, m_uri);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = request_parse_state::parsed_uri;
+
+        result = handler().on_uri(m_uri);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == request_parse_state::parsed_uri)
+    {
+        auto result = parse_request_version_common(data, m_pos, m_version);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = request_parse_state::parsed_version;
+        m_headers_start = m_pos;
+
+        result = handler().on_version(m_version);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == request_parse_state::parsed_version)
+    {
+        // Unlike request, this parser always moves to parsed_headers, even without any headers.
+        auto result = parse_headers_common<policy_type, request_parse_state, request_parse_result>(
+            data,
+            m_pos,
+            m_headers_start,
+            true,
+            m_body_type,
+            m_content_length,
+            m_parse_state,
+            [this](std::string_view name, std::string_view value) -> request_parse_result
+            {
+                ++m_header_count;
+                return handler().on_header(name, value);
+            }
+        );
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+
+        result = handler().on_headers_complete();
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(    m_parse_state == request_parse_state::parsed_headers
+        && m_body_type != body_type::no_body
+    )
+    {
+        auto result = parse_body_common<policy_type, request_parse_state, request_parse_result>(
+            data,
+            m_parse_state,
+            m_pos,
+            m_body_type,
+            m_content_length,
+            [this, &data](std::size_t offset, std::size_t length) -> request_parse_result
+            {
+                return handler().on_body(data.subspan(offset, length));
+            }
+        );
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    return request_parse_result::complete;
+}
+
+template<typename derived_type, typename policy_type>
+auto request_event_parser<derived_type, policy_type>::reset() -> void
+{
+    m_parse_state = request_parse_state::start;
+    m_pos = 0;
+    m_uri_start_pos = 0;
+    m_headers_start = 0;
+    m_header_count = 0;
+    m_body_type = body_type::no_body;
+    m_content_length = 0;
+}
+
+template<typename derived_type, typename policy_type>
+auto response_event_parser<derived_type, policy_type>::parse(std::string& data) -> response_parse_result
+{
+    std::span<char> data_span{data.data(), data.length()};
+    return parse(data_span);
+}
+
+template<typename derived_type, typename policy_type>
+auto response_event_parser<derived_type, policy_type>::parse(std::span<char>& data) -> response_parse_result
+{
+    if(data.empty())
+    {
+        return response_parse_result::incomplete;
+    }
+
+    if(m_parse_state == response_parse_state::start)
+    {
+        auto result = parse_response_version_common(data, m_pos, m_version);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = response_parse_state::parsed_version;
+
+        result = handler().on_version(m_version);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == response_parse_state::parsed_version)
+    {
+        auto result = parse_status_code_common(data, m_pos, m_status_code);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = response_parse_state::parsed_status_code;
+
+        result = handler().on_status_code(m_status_code);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == response_parse_state::parsed_status_code)
+    {
+        auto result = parse_reason_phrase_common(data, m_pos, m_reason_phrase);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+        m_parse_state = response_parse_state::parsed_reason_phrase;
+        m_headers_start = m_pos;
+
+        result = handler().on_reason_phrase(m_reason_phrase);
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == response_parse_state::parsed_reason_phrase)
+    {
+        // Unlike response, this parser always moves to parsed_headers, even without any headers.
+        auto result = parse_headers_common<policy_type, response_parse_state, response_parse_result>(
+            data,
+            m_pos,
+            m_headers_start,
+            true,
+            m_body_type,
+            m_content_length,
+            m_parse_state,
+            [this](std::string_view name, std::string_view value) -> response_parse_result
+            {
+                ++m_header_count;
+                return handler().on_header(name, value);
+            }
+        );
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+
+        result = handler().on_headers_complete();
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(    m_parse_state == response_parse_state::parsed_headers
+        && m_body_type != body_type::no_body
+    )
+    {
+        auto result = parse_body_common<policy_type, response_parse_state, response_parse_result>(
+            data,
+            m_parse_state,
+            m_pos,
+            m_body_type,
+            m_content_length,
+            [this, &data](std::size_t offset, std::size_t length) -> response_parse_result
+            {
+                return handler().on_body(data.subspan(offset, length));
+            }
+        );
+        if(result != response_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    return response_parse_result::complete;
+}
+
+template<typename derived_type, typename policy_type>
+auto response_event_parser<derived_type, policy_type>::reset() -> void
+{
+    m_parse_state = response_parse_state::start;
+    m_pos = 0;
+    m_status_code = 0;
+    m_headers_start = 0;
+    m_header_count = 0;
+    m_body_type = body_type::no_body;
+    m_content_length = 0;
+}
+
+} // namespace turbo::http
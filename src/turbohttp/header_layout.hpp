@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace turbo::http
+{
+
+/**
+ * How often the learned header layout predicted a header name, see request::header_layout_stats().
+ */
+struct header_layout_stats
+{
+    /// Headers whose name was verified against the learned layout instead of scanned for the ':'.
+    std::uint64_t hits{0};
+    /// Headers parsed while the layout cache is enabled.
+    std::uint64_t lookups{0};
+
+    /**
+     * @return hits / lookups, 0 if nothing has been parsed yet.
+     */
+    auto hit_rate() const -> double
+    {
+        return (lookups == 0) ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+};
+
+/**
+ * The header names of the previous request parsed by the same parser, in order.  Keep-alive
+ * clients tend to send the same header names in the same order on every request, so the name of
+ * header 'i' is first compared with a memcmp against learned name 'i' and only scanned for the ':'
+ * on a mismatch.  After the first mismatch in a request the rest of its headers are scanned and
+ * the learned layout is replaced by this request's names.
+ *
+ * The names are copied into an inline buffer of 'capacity' bytes since the data of the previous
+ * request is gone by the time the next one is parsed, names past the capacity are not learned.
+ * A hit can never change the result of parsing, the learned names never contain a ':' (nor a
+ * non tchar byte with the strict_policy) so the ':' after a matching name is always the first one.
+ *
+ * @tparam header_count The maximum number of headers of the request.
+ * @tparam capacity The bytes available for the learned names, 0 disables the cache.
+ */
+template<std::size_t header_count, std::size_t capacity>
+class header_layout
+{
+public:
+    /**
+     * Starts matching a new request against the learned layout.
+     */
+    auto restart() -> void
+    {
+        m_matching = m_count > 0;
+        m_recorded = 0;
+        m_predicted = 0;
+    }
+
+    /**
+     * @param data The request data.
+     * @param pos The start of header 'index'.
+     * @param index The index of the header in the request.
+     * @return The position of the ':' after the learned name if the data at 'pos' matches it,
+     *         otherwise std::string_view::npos and the header has to be scanned.
+     */
+    auto predict(std::span<const char> data, std::size_t pos, std::size_t index) -> std::size_t
+    {
+        if(!m_matching || index >= m_count)
+        {
+            return std::string_view::npos;
+        }
+
+        std::size_t start = (index == 0) ? 0 : m_ends[index - 1];
+        std::size_t end = m_ends[index];
+        if(end < start || pos + (end - start) >= data.size())
+        {
+            // Not enough data to tell yet.
+            return std::string_view::npos;
+        }
+
+        std::size_t colon = pos + (end - start);
+        if(std::memcmp(data.data() + pos, m_names.data() + start, end - start) != 0 || data[colon] != ':')
+        {
+            m_matching = false;
+            return std::string_view::npos;
+        }
+
+        m_predicted = index + 1;
+        return colon;
+    }
+
+    /**
+     * Learns the name of header 'index' of the current request, called for every stored header.
+     */
+    auto record(std::size_t index, std::string_view name) -> void
+    {
+        ++m_stats.lookups;
+        if(m_predicted == index + 1)
+        {
+            // The learned name is already this name.
+            ++m_stats.hits;
+            m_recorded = index + 1;
+            return;
+        }
+
+        m_matching = false;
+        learn(index, name);
+    }
+
+    /**
+     * Matches the name of header 'index' of a request attached part way through its headers
+     * against the learned layout, called for every header parsed before it was detached so the
+     * rest of its headers are predicted and learned as if it had never been detached.  Not
+     * counted in the stats, they were counted when the headers were parsed.
+     */
+    auto resume(std::size_t index, std::string_view name) -> void
+    {
+        if(m_matching && index < m_count && m_recorded == index)
+        {
+            std::size_t start = (index == 0) ? 0 : m_ends[index - 1];
+            if(name == std::string_view{m_names.data() + start, m_ends[index] - start})
+            {
+                m_recorded = index + 1;
+                return;
+            }
+        }
+
+        m_matching = false;
+        learn(index, name);
+    }
+
+    /**
+     * The headers of the current request are complete, its layout is used for the next request.
+     */
+    auto finish() -> void
+    {
+        m_count = m_recorded;
+    }
+
+    auto stats() const -> const header_layout_stats& { return m_stats; }
+
+private:
+    /**
+     * Copies the name of header 'index' into the layout after the names already learned.
+     */
+    auto learn(std::size_t index, std::string_view name) -> void
+    {
+        std::size_t start = (index == 0) ? 0 : m_ends[index - 1];
+        if(m_recorded != index || name.length() > capacity - start)
+        {
+            // Out of space, the layout ends at the previous header.
+            return;
+        }
+        std::memcpy(m_names.data() + start, name.data(), name.length());
+        m_ends[index] = static_cast<std::uint32_t>(start + name.length());
+        m_recorded = index + 1;
+    }
+
+    /// The learned names back to back.
+    std::array<char, capacity> m_names{};
+    /// The end of each learned name in 'm_names', name 'i' starts at the end of name 'i - 1'.
+    std::array<std::uint32_t, header_count> m_ends{};
+    /// The number of learned names.
+    std::size_t m_count{0};
+    /// The number of names of the current request that are learned.
+    std::size_t m_recorded{0};
+    /// One past the index of the header the last prediction was a hit for.
+    std::size_t m_predicted{0};
+    /// Does the current request match the learned layout so far?
+    bool m_matching{false};
+    header_layout_stats m_stats{};
+};
+
+/**
+ * The disabled header layout cache.
+ */
+template<std::size_t header_count>
+class header_layout<header_count, 0>
+{
+public:
+    auto restart() -> void { }
+    auto predict(std::span<const char>, std::size_t, std::size_t) -> std::size_t { return std::string_view::npos; }
+    auto record(std::size_t, std::string_view) -> void { }
+    auto resume(std::size_t, std::string_view) -> void { }
+    auto finish() -> void { }
+    auto stats() const -> const header_layout_stats& { return m_stats; }
+
+private:
+    static constexpr header_layout_stats m_stats{};
+};
+
+} // namespace turbo::http
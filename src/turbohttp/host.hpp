@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace turbo::http
+{
+
+namespace host_detail
+{
+
+/// The 64 bit FNV-1a offset basis and prime.
+inline constexpr std::uint64_t fnv_offset{0xCBF29CE484222325};
+inline constexpr std::uint64_t fnv_prime{0x100000001B3};
+
+constexpr auto lower(char c) -> char
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+constexpr auto hash_byte(std::uint64_t hash, char c) -> std::uint64_t
+{
+    return (hash ^ static_cast<unsigned char>(lower(c))) * fnv_prime;
+}
+
+} // namespace host_detail
+
+/**
+ * The Host header value split by split_host().
+ */
+struct host_split
+{
+    /// The host without the port and trailing dot, an IPv6 literal includes the brackets.
+    std::string_view name{};
+    /// host_hash() of 'name'.
+    std::uint64_t hash{host_detail::fnv_offset};
+    /// Does 'name' have an uppercase letter?
+    bool has_upper{false};
+};
+
+/**
+ * The hash the request computes for its Host, see request::http_host_hash(), for building the
+ * virtual host table the requests are looked up in.  The hash is 64 bit FNV-1a of the lowercased
+ * host so it is case insensitive.
+ * @param host A host without the port or trailing dot, e.g. "www.example.com".
+ */
+constexpr auto host_hash(std::string_view host) -> std::uint64_t
+{
+    std::uint64_t hash = host_detail::fnv_offset;
+    for(char c : host)
+    {
+        hash = host_detail::hash_byte(hash, c);
+    }
+    return hash;
+}
+
+/**
+ * A hasher for std::unordered_map or similar virtual host tables keyed by the host, the same hash
+ * as request::http_host_hash().  With host_equal the table is looked up with request::http_host_key()
+ * without hashing the host again, e.g. vhosts.find(request.http_host_key()).
+ */
+struct host_hasher
+{
+    using is_transparent = void;
+
+    auto operator()(std::string_view host) const -> std::size_t { return static_cast<std::size_t>(host_hash(host)); }
+    auto operator()(const host_split& host) const -> std::size_t { return static_cast<std::size_t>(host.hash); }
+};
+
+/**
+ * The case insensitive key equality for host_hasher tables.
+ */
+struct host_equal
+{
+    using is_transparent = void;
+
+    constexpr auto operator()(std::string_view a, std::string_view b) const -> bool
+    {
+        if(a.length() != b.length())
+        {
+            return false;
+        }
+        for(std::size_t i = 0; i < a.length(); ++i)
+        {
+            if(host_detail::lower(a[i]) != host_detail::lower(b[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    constexpr auto operator()(const host_split& a, std::string_view b) const -> bool { return (*this)(a.name, b); }
+    constexpr auto operator()(std::string_view a, const host_split& b) const -> bool { return (*this)(a, b.name); }
+};
+
+/**
+ * Splits the port and the trailing dot of a fully qualified name off a Host header value and
+ * hashes the host in the same pass, e.g. "Example.COM.:8080" is "Example.COM".
+ * @param value The Host header value, already trimmed.
+ */
+constexpr auto split_host(std::string_view value) -> host_split
+{
+    host_split split{};
+    std::size_t end = 0;
+    if(!value.empty() && value[0] == '[')
+    {
+        // An IPv6 literal's colons are inside its brackets.
+        while(end < value.length() && value[end] != ']')
+        {
+            split.hash = host_detail::hash_byte(split.hash, value[end]);
+            split.has_upper |= (value[end] >= 'A' && value[end] <= 'Z');
+            ++end;
+        }
+        if(end < value.length())
+        {
+            split.hash = host_detail::hash_byte(split.hash, value[end]);
+            ++end;
+        }
+        split.name = value.substr(0, end);
+        return split;
+    }
+
+    // A '.' is only hashed once a byte follows it so a trailing dot never is.
+    bool dot = false;
+    for(; end < value.length() && value[end] != ':'; ++end)
+    {
+        char c = value[end];
+        if(dot)
+        {
+            split.hash = host_detail::hash_byte(split.hash, '.');
+        }
+        dot = c == '.';
+        if(!dot)
+        {
+            split.hash = host_detail::hash_byte(split.hash, c);
+            split.has_upper |= (c >= 'A' && c <= 'Z');
+        }
+    }
+    split.name = value.substr(0, end - (dot ? 1 : 0));
+    return split;
+}
+
+} // namespace turbo::http
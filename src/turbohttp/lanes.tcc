@@ -0,0 +1,350 @@
+#pragma once
+
+#include "turbohttp/lanes.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace turbo::http::experimental
+{
+
+/**
+ * The states of the lane framing state machine, every state fits in the low nibble so the
+ * transitions are single byte shuffles.
+ */
+namespace lane_state
+{
+    inline constexpr std::uint8_t method      = 0;
+    inline constexpr std::uint8_t uri         = 1;
+    inline constexpr std::uint8_t version     = 2;
+    inline constexpr std::uint8_t version_lf  = 3;
+    inline constexpr std::uint8_t line_start  = 4;
+    inline constexpr std::uint8_t name        = 5;
+    inline constexpr std::uint8_t value       = 6;
+    inline constexpr std::uint8_t value_lf    = 7;
+    inline constexpr std::uint8_t end_lf      = 8;
+    inline constexpr std::uint8_t done        = 9;
+    inline constexpr std::uint8_t error       = 10;
+} // namespace lane_state
+
+/**
+ * One next state table per character class, indexed by the current state.  Only the transitions
+ * the lenient request::parse() would agree with are taken, anything else goes to 'error' and the
+ * lane is handed to request::parse().
+ */
+struct lane_transitions
+{
+    std::array<std::uint8_t, 16> other{};
+    std::array<std::uint8_t, 16> sp{};
+    std::array<std::uint8_t, 16> cr{};
+    std::array<std::uint8_t, 16> lf{};
+    std::array<std::uint8_t, 16> colon{};
+    /// 0xFF for the states whose offset is recorded when they are entered.
+    std::array<std::uint8_t, 16> recorded{};
+};
+
+inline constexpr lane_transitions lane_table = []() {
+    lane_transitions t{};
+    for(std::uint8_t s = 0; s < 16; ++s)
+    {
+        // By default every class stays in the current state, unused states are errors.
+        std::uint8_t same = (s <= lane_state::error) ? s : lane_state::error;
+        t.other[s] = t.sp[s] = t.cr[s] = t.lf[s] = t.colon[s] = same;
+    }
+
+    t.sp[lane_state::method] = lane_state::uri;
+    t.sp[lane_state::uri] = lane_state::version;
+    t.cr[lane_state::version] = lane_state::version_lf;
+
+    t.other[lane_state::version_lf] = t.sp[lane_state::version_lf] = t.cr[lane_state::version_lf] = t.colon[lane_state::version_lf] = lane_state::error;
+    t.lf[lane_state::version_lf] = lane_state::line_start;
+
+    t.other[lane_state::line_start] = t.sp[lane_state::line_start] = t.lf[lane_state::line_start] = lane_state::name;
+    t.cr[lane_state::line_start] = lane_state::end_lf;
+    t.colon[lane_state::line_start] = lane_state::error;
+
+    t.cr[lane_state::name] = lane_state::error;
+    t.colon[lane_state::name] = lane_state::value;
+    t.cr[lane_state::value] = lane_state::value_lf;
+
+    t.other[lane_state::value_lf] = t.sp[lane_state::value_lf] = t.cr[lane_state::value_lf] = t.colon[lane_state::value_lf] = lane_state::error;
+    t.lf[lane_state::value_lf] = lane_state::line_start;
+
+    t.other[lane_state::end_lf] = t.sp[lane_state::end_lf] = t.cr[lane_state::end_lf] = t.colon[lane_state::end_lf] = lane_state::error;
+    t.lf[lane_state::end_lf] = lane_state::done;
+
+    for(auto s : {lane_state::uri, lane_state::version, lane_state::version_lf, lane_state::name, lane_state::value, lane_state::value_lf, lane_state::done})
+    {
+        t.recorded[s] = 0xFF;
+    }
+    return t;
+}();
+
+template<std::size_t header_count, typename policy_type>
+auto lane_engine<request<header_count, policy_type>>::parse(std::span<batch_entry<request_type>> batch) -> void
+{
+    for(std::size_t first = 0; first < batch.size(); first += lane_count)
+    {
+        std::size_t count = (batch.size() - first < lane_count) ? batch.size() - first : lane_count;
+        parse_group(batch.subspan(first, count));
+    }
+}
+
+template<std::size_t header_count, typename policy_type>
+auto lane_engine<request<header_count, policy_type>>::parse_group(std::span<batch_entry<request_type>> group) -> void
+{
+    for(auto& entry : group)
+    {
+        entry.parser->reset();
+    }
+
+#if defined(__SSSE3__)
+    if constexpr(supported)
+    {
+        std::array<std::array<std::uint32_t, max_events>, lane_count> events{};
+        std::array<std::size_t, lane_count> event_counts{};
+        std::array<std::size_t, lane_count> lengths{};
+        std::array<char, lane_count> initial{};
+
+        std::size_t max_length{0};
+        for(std::size_t lane = 0; lane < lane_count; ++lane)
+        {
+            // Missing lanes and lanes too large for the offsets start out finished.
+            if(lane < group.size() && group[lane].data.size() < std::numeric_limits<std::uint32_t>::max())
+            {
+                lengths[lane] = group[lane].data.size();
+                max_length = (lengths[lane] > max_length) ? lengths[lane] : max_length;
+                initial[lane] = static_cast<char>(lane_state::method);
+            }
+            else
+            {
+                initial[lane] = static_cast<char>(lane_state::error);
+            }
+        }
+
+        auto load_table = [](const std::array<std::uint8_t, 16>& table) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(table.data()));
+        };
+        const __m128i table_other = load_table(lane_table.other);
+        const __m128i table_sp = load_table(lane_table.sp);
+        const __m128i table_cr = load_table(lane_table.cr);
+        const __m128i table_lf = load_table(lane_table.lf);
+        const __m128i table_colon = load_table(lane_table.colon);
+        const __m128i table_recorded = load_table(lane_table.recorded);
+        const __m128i char_sp = _mm_set1_epi8(' ');
+        const __m128i char_cr = _mm_set1_epi8('\r');
+        const __m128i char_lf = _mm_set1_epi8('\n');
+        const __m128i char_colon = _mm_set1_epi8(':');
+        const __m128i high_bit = _mm_set1_epi8(static_cast<char>(0x80));
+        const __m128i finished_after = _mm_set1_epi8(static_cast<char>(lane_state::end_lf));
+
+        __m128i state = _mm_setzero_si128();
+        std::memcpy(&state, initial.data(), lane_count);
+
+        // Plain arrays, std::array drops the vector type's alignment attributes.
+        __m128i rows[lane_count];
+        __m128i columns[16];
+
+        for(std::size_t block = 0; block < max_length; block += 16)
+        {
+            // Load 16 bytes of every lane, the end of a lane is padded with zeros which like any
+            // other character only change the line_start and \n expecting states.
+            for(std::size_t lane = 0; lane < lane_count; ++lane)
+            {
+                if(block + 16 <= lengths[lane])
+                {
+                    rows[lane] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group[lane].data.data() + block));
+                }
+                else
+                {
+                    std::array<char, 16> padded{};
+                    if(block < lengths[lane])
+                    {
+                        std::memcpy(padded.data(), group[lane].data.data() + block, lengths[lane] - block);
+                    }
+                    rows[lane] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded.data()));
+                }
+            }
+
+            // Transpose the 8x16 block, the low 8 bytes of columns[j] are byte 'block + j' of each lane.
+            __m128i t0 = _mm_unpacklo_epi8(rows[0], rows[1]);
+            __m128i t1 = _mm_unpackhi_epi8(rows[0], rows[1]);
+            __m128i t2 = _mm_unpacklo_epi8(rows[2], rows[3]);
+            __m128i t3 = _mm_unpackhi_epi8(rows[2], rows[3]);
+            __m128i t4 = _mm_unpacklo_epi8(rows[4], rows[5]);
+            __m128i t5 = _mm_unpackhi_epi8(rows[4], rows[5]);
+            __m128i t6 = _mm_unpacklo_epi8(rows[6], rows[7]);
+            __m128i t7 = _mm_unpackhi_epi8(rows[6], rows[7]);
+            __m128i u0 = _mm_unpacklo_epi16(t0, t2);
+            __m128i u1 = _mm_unpackhi_epi16(t0, t2);
+            __m128i u2 = _mm_unpacklo_epi16(t1, t3);
+            __m128i u3 = _mm_unpackhi_epi16(t1, t3);
+            __m128i u4 = _mm_unpacklo_epi16(t4, t6);
+            __m128i u5 = _mm_unpackhi_epi16(t4, t6);
+            __m128i u6 = _mm_unpacklo_epi16(t5, t7);
+            __m128i u7 = _mm_unpackhi_epi16(t5, t7);
+            const __m128i pairs[8] = {
+                _mm_unpacklo_epi32(u0, u4), _mm_unpackhi_epi32(u0, u4),
+                _mm_unpacklo_epi32(u1, u5), _mm_unpackhi_epi32(u1, u5),
+                _mm_unpacklo_epi32(u2, u6), _mm_unpackhi_epi32(u2, u6),
+                _mm_unpacklo_epi32(u3, u7), _mm_unpackhi_epi32(u3, u7)
+            };
+            for(std::size_t k = 0; k < 8; ++k)
+            {
+                columns[2 * k] = pairs[k];
+                columns[2 * k + 1] = _mm_srli_si128(pairs[k], 8);
+            }
+
+            for(std::size_t j = 0; j < 16; ++j)
+            {
+                const __m128i bytes = columns[j];
+                const __m128i is_sp = _mm_cmpeq_epi8(bytes, char_sp);
+                const __m128i is_cr = _mm_cmpeq_epi8(bytes, char_cr);
+                const __m128i is_lf = _mm_cmpeq_epi8(bytes, char_lf);
+                const __m128i is_colon = _mm_cmpeq_epi8(bytes, char_colon);
+                const __m128i is_special = _mm_or_si128(_mm_or_si128(is_sp, is_cr), _mm_or_si128(is_lf, is_colon));
+
+                // A shuffle index with the high bit set yields 0, so only the table of each lane's class contributes.
+                const __m128i from_other = _mm_shuffle_epi8(table_other, _mm_or_si128(state, _mm_and_si128(is_special, high_bit)));
+                const __m128i from_sp = _mm_shuffle_epi8(table_sp, _mm_or_si128(state, _mm_andnot_si128(is_sp, high_bit)));
+                const __m128i from_cr = _mm_shuffle_epi8(table_cr, _mm_or_si128(state, _mm_andnot_si128(is_cr, high_bit)));
+                const __m128i from_lf = _mm_shuffle_epi8(table_lf, _mm_or_si128(state, _mm_andnot_si128(is_lf, high_bit)));
+                const __m128i from_colon = _mm_shuffle_epi8(table_colon, _mm_or_si128(state, _mm_andnot_si128(is_colon, high_bit)));
+                const __m128i next = _mm_or_si128(
+                    _mm_or_si128(from_other, from_sp),
+                    _mm_or_si128(_mm_or_si128(from_cr, from_lf), from_colon)
+                );
+
+                const __m128i entered = _mm_andnot_si128(_mm_cmpeq_epi8(next, state), _mm_shuffle_epi8(table_recorded, next));
+                auto recorded = static_cast<std::uint32_t>(_mm_movemask_epi8(entered)) & 0xFF;
+                while(recorded != 0)
+                {
+                    auto lane = static_cast<std::size_t>(__builtin_ctz(recorded));
+                    recorded &= recorded - 1;
+                    if(event_counts[lane] < max_events)
+                    {
+                        events[lane][event_counts[lane]] = static_cast<std::uint32_t>(block + j);
+                    }
+                    ++event_counts[lane];
+                }
+
+                state = next;
+            }
+
+            // Stop once every lane is done or in error.
+            auto finished = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(state, finished_after))) & 0xFF;
+            if(finished == 0xFF)
+            {
+                break;
+            }
+        }
+
+        std::array<char, lane_count> final_states{};
+        std::memcpy(final_states.data(), &state, lane_count);
+
+        for(std::size_t lane = 0; lane < group.size(); ++lane)
+        {
+            auto& entry = group[lane];
+            if(final_states[lane] == static_cast<char>(lane_state::done) && event_counts[lane] <= max_events)
+            {
+                auto result = fill(*entry.parser, entry.data, events[lane].data(), event_counts[lane]);
+                if(result.has_value())
+                {
+                    entry.result = result.value();
+                    continue;
+                }
+                entry.parser->reset();
+            }
+            entry.result = entry.parser->parse(entry.data);
+        }
+        return;
+    }
+#endif
+
+    for(auto& entry : group)
+    {
+        entry.result = entry.parser->parse(entry.data);
+    }
+}
+
+template<std::size_t header_count, typename policy_type>
+auto lane_engine<request<header_count, policy_type>>::fill(
+    request_type& r,
+    std::span<char>& data,
+    const std::uint32_t* events,
+    std::size_t event_count
+) -> std::optional<request_parse_result>
+{
+    if(    r.m_hooks.on_request_line != nullptr
+        || r.m_hooks.on_header != nullptr
+        || event_count < 4
+        || (event_count - 4) % 3 != 0
+    )
+    {
+        return std::nullopt;
+    }
+
+    // The method and version are short, the scalar parsers also validate them.
+    if(parse_method_common(data, r.m_pos, r.m_method) != request_parse_result::advance || r.m_pos != events[0] + 1)
+    {
+        return std::nullopt;
+    }
+
+    r.m_uri_start_pos = r.m_pos;
+    r.m_uri = std::string_view{data.data() + r.m_pos, events[1] - r.m_pos};
+    if(!split_uri_common(r.m_uri, r.m_uri_split) && policy_type::strict)
+    {
+        // The scalar parse reports the malformed authority.
+        return std::nullopt;
+    }
+    r.m_pos = events[1] + 1;
+
+    if(parse_request_version_common(data, r.m_pos, r.m_version) != request_parse_result::advance || r.m_pos != events[2] + 2)
+    {
+        return std::nullopt;
+    }
+    r.m_headers_start = r.m_pos;
+
+    const std::size_t headers = (event_count - 4) / 3;
+    for(std::size_t i = 0; i < headers; ++i)
+    {
+        std::size_t name_start = events[3 + i * 3];
+        std::size_t name_end = events[4 + i * 3];
+        std::size_t value_start = name_end + 1;
+        std::size_t value_end = events[5 + i * 3];
+
+        // Left and right trim the same as parse_headers_common.
+        while(value_start < value_end && is_http_ws(data[value_start]))
+        {
+            ++value_start;
+        }
+        while(value_end > value_start && is_http_ws(data[value_end - 1]))
+        {
+            --value_end;
+        }
+
+        std::string_view name{data.data() + name_start, name_end - name_start};
+        std::string_view value{data.data() + value_start, value_end - value_start};
+        r.m_headers[i] = {name, value};
+        r.record_host(name, value);
+        detect_body_type_lenient(name, value, r.m_body_type, r.m_content_length);
+    }
+    r.m_header_count = headers;
+    r.lowercase_host(data);
+    r.m_pos = events[event_count - 1] + 1;
+
+    // A request without any headers remains in parsed_version, the same as parse_headers_common.
+    r.m_parse_state = (headers > 0) ? request_parse_state::parsed_headers : request_parse_state::parsed_version;
+    if(r.m_body_type != body_type::no_body)
+    {
+        return r.parse(data);
+    }
+    return request_parse_result::complete;
+}
+
+} // namespace turbo::http::experimental
@@ -1,11 +1,20 @@
 #pragma once
 
+#include "turbohttp/arena.hpp"
+#include "turbohttp/body_chunks.hpp"
+#include "turbohttp/checkpoint.hpp"
+#include "turbohttp/header_layout.hpp"
+#include "turbohttp/host.hpp"
 #include "turbohttp/method.hpp"
+#include "turbohttp/policy.hpp"
+#include "turbohttp/query.hpp"
 #include "turbohttp/version.hpp"
 
 #include <string>
 #include <optional>
 #include <array>
+#include <cstdint>
+#include <memory_resource>
 #include <span>
 
 // The cmake build system will define this and allows overriding.
@@ -25,7 +34,7 @@ enum class body_type
 
 enum class request_parse_result
 {
-    /// Go to the next stage of parsing.
+    /// Go to the next stage of parsing, also returned by parse_until() when it stops at the target state.
     advance,
     /// Parsing this request is completed, all fields are appropriately set.
     complete,
@@ -40,7 +49,23 @@ enum class request_parse_result
     /// The maximum number of headers has been exceeded, error parse result.
     maximum_headers_exceeded,
     /// A malformed chunk was encountered, error parse result.
-    chunk_malformed
+    chunk_malformed,
+    /// A request hook rejected the request, error parse result.
+    rejected,
+    /// The uri contains invalid characters (strict_policy only), error parse result.
+    uri_malformed,
+    /// A header name or value is malformed or an obs-fold was encountered (strict_policy only), error parse result.
+    header_malformed,
+    /// The Content-Length is malformed or conflicts with another framing header (strict_policy only), error parse result.
+    content_length_malformed,
+    /// The uri is longer than the policy's max_uri_length, error parse result.
+    uri_too_long,
+    /// The header block is larger than the policy's max_header_bytes, error parse result.
+    headers_too_large,
+    /// A header value is longer than the policy's max_header_value_length, error parse result.
+    header_value_too_long,
+    /// The body is larger than the policy's max_body_length, error parse result.
+    body_too_large
 };
 
 enum class request_parse_state
@@ -59,11 +84,107 @@ enum class request_parse_state
     parsed_body
 };
 
-template<std::size_t header_count = TURBOHTTP_HEADER_COUNT>
-class request
+/**
+ * Optional callbacks invoked while parsing a request so the application can reject it early,
+ * e.g. an unknown route or a disallowed method, without parsing the remainder of the request.
+ * Each hook returns 'advance' to continue parsing, any other value stops parsing and is returned
+ * from parse(), 'rejected' is provided for application specific rejections.  Capture-less lambdas
+ * can be assigned to the hooks, state should be passed through 'user_data'.
+ */
+struct request_hooks
+{
+    /// Invoked once the method and uri have been parsed.
+    request_parse_result (*on_request_line)(void* user_data, method m, std::string_view uri){nullptr};
+    /// Invoked after each header has been stored.
+    request_parse_result (*on_header)(void* user_data, std::string_view name, std::string_view value){nullptr};
+    /// Passed as the first argument to each hook.
+    void* user_data{nullptr};
+};
+
+/**
+ * The form of a request target (RFC 9112 3.2).
+ */
+enum class target_form : std::uint8_t
+{
+    /// "/path?query", the target of a request to an origin server.
+    origin,
+    /// "http://host:port/path?query", the target of a request to a forward proxy.
+    absolute,
+    /// "host:port", the target of a CONNECT.
+    authority,
+    /// "*", the target of a server wide OPTIONS.
+    asterisk
+};
+
+/**
+ * Where the uri splits into the path, query and fragment, found while scanning the uri for the
+ * space after it.  The path and query ends are offsets into the uri, 'unsplit' until the uri has
+ * been scanned that far.  The scheme and authority of an absolute-form or authority-form uri are
+ * split off once the uri has been scanned, the other offsets are only set for those forms.
+ */
+struct uri_split
+{
+    static constexpr std::uint32_t unsplit{0xFFFFFFFF};
+
+    /// The first '?' or '#', the uri's length if there is neither.
+    std::uint32_t path_end{unsplit};
+    /// The first '#', the uri's length if there is none.
+    std::uint32_t query_end{unsplit};
+    /// The start of the path, after the scheme and authority of an absolute-form uri.
+    std::uint32_t path_start{0};
+    /// The host of an absolute-form or authority-form uri, an IPv6 literal includes the brackets.
+    std::uint32_t host_start{0};
+    std::uint32_t host_end{0};
+    /// The port of an absolute-form or authority-form uri, the scheme's default port if it has none.
+    std::uint16_t port{0};
+    target_form form{target_form::origin};
+};
+
+/**
+ * The resumable state of a request detached from the parser with request::detach(), for
+ * connections that are idle most of the time.  Only this POD has to live with the connection, a
+ * full request with its header array is bound with request::attach() while data is being parsed,
+ * e.g. from a scratch_pool.  The uri, header and body views are rebuilt from the data on attach so
+ * the data must be the same buffer contents it was detached from, up to 4 GiB.
+ */
+struct request_state
+{
+    /// The Content-Length value, or the decoded length of a chunked body so far.
+    std::uint64_t content_length{0};
+    /// Where parsing continues from.
+    std::uint32_t pos{0};
+    /// The start of the uri, 0 until the uri is started.
+    std::uint32_t uri_start{0};
+    /// The length of the uri once parsed.
+    std::uint32_t uri_length{0};
+    /// The start of the headers.
+    std::uint32_t headers_start{0};
+    /// The start of a chunked body.
+    std::uint32_t body_start{0};
+    /// The request_parse_state.
+    std::uint8_t parse_state{0};
+    /// The method.
+    std::uint8_t method{0};
+    /// The version.
+    std::uint8_t version{0};
+    /// The body_type.
+    std::uint8_t body_type{0};
+};
+
+static_assert(sizeof(request_state) == 32);
+
+namespace experimental
+{
+template<typename request_type>
+class lane_engine;
+} // namespace experimental
+
+template<std::size_t header_count = TURBOHTTP_HEADER_COUNT, typename policy_type = lenient_policy>
+class alignas(policy_type::parser_alignment) request
 {
 public:
-    request() = default;
+    // User provided so a value initialized request does not zero the arena's inline storage.
+    request() { }
     ~request() = default;
 
     request(const request&) = default;
@@ -91,24 +212,142 @@ public:
 
     auto parse(std::span<char>& data) -> request_parse_result;
 
+    /**
+     * A read-only parse for data that cannot be modified, e.g. a PROT_READ memory mapped capture.
+     * The data is never written to, a chunked body is not decoded in place so http_body() stays
+     * empty and the chunks are available through http_body_chunks() instead.
+     *
+     * @param data The full HTTP request data.
+     * @return The current state of parsing the HTTP request data.
+     */
+    auto parse(std::span<const char> data) -> request_parse_result;
+
+    /**
+     * Parses the request only as far as the 'target' state, useful when only the method and
+     * uri (parsed_uri) or the headers (parsed_headers) are required, e.g. to route the request.
+     * Parsing can be resumed later with parse() or another parse_until() with the same data,
+     * previously parsed stages are not re-parsed.
+     *
+     * @param data The full HTTP request data.  If this is a chunked request, it will be mutated.
+     * @param target The parse state to stop parsing at.
+     * @return 'advance' if parsing stopped at the target state, 'complete' if the entire request
+     *         was parsed before reaching the target, otherwise the same results as parse().
+     */
+    auto parse_until(std::string& data, request_parse_state target) -> request_parse_result;
+
+    auto parse_until(std::span<char>& data, request_parse_state target) -> request_parse_result;
+
+    /// A read-only parse_until(), see the read-only parse().
+    auto parse_until(std::span<const char> data, request_parse_state target) -> request_parse_result;
+
 private:
-    auto parse_method(std::span<char>& data) -> request_parse_result;
-    auto parse_uri(std::span<char>& data) -> request_parse_result;
-    auto parse_version(std::span<char>& data) -> request_parse_result;
-    auto parse_headers(std::span<char>& data) -> request_parse_result;
-    auto parse_body(std::span<char>& data) -> request_parse_result;
+    /// 'char_type' is 'const char' for the read-only parse.
+    template<typename char_type>
+    auto parse_until_impl(std::span<char_type> data, request_parse_state target) -> request_parse_result;
+    /// parse_until_impl() for dispatch_engine::computed_goto.
+    template<typename char_type>
+    auto parse_until_goto(std::span<char_type> data, request_parse_state target) -> request_parse_result;
+    /// The body stage and completion check of parse_until_impl(), shared with dispatch_engine::dfa.
+    template<typename char_type>
+    auto parse_until_body(std::span<char_type> data, request_parse_state target) -> request_parse_result;
+    /// Parses the request line and headers for dispatch_engine::dfa.
+    auto parse_head_dfa(std::span<const char> data, request_parse_state target) -> request_parse_result;
+
+    auto parse_method(std::span<const char> data) -> request_parse_result;
+    auto parse_uri(std::span<const char> data) -> request_parse_result;
+    auto parse_version(std::span<const char> data) -> request_parse_result;
+    auto parse_headers(std::span<const char> data) -> request_parse_result;
+    auto store_header(std::string_view name, std::string_view value) -> request_parse_result;
+    /// Splits and hashes the Host header if 'name' is the first one, see http_host().
+    auto record_host(std::string_view name, std::string_view value) -> void;
+    /// Lowercases the Host header recorded by record_host() in the mutable data.
+    auto lowercase_host(std::span<char> data) -> void;
+    template<typename char_type>
+    auto parse_body(std::span<char_type> data) -> request_parse_result;
+    /// 'split_headers' is false when restore() sets the headers from the checkpoint instead.
+    template<typename char_type>
+    auto attach_impl(const request_state& state, std::span<char_type> data, bool split_headers) -> void;
+    template<typename char_type>
+    auto restore_impl(std::span<const std::byte> blob, std::span<char_type> data) -> bool;
 public:
 
     /**
      * Resets the parser to default constructed state to parse another request.
+     * The hooks are kept.
      */
     auto reset() -> void;
 
+    /**
+     * Sets the hooks to invoke while parsing, pass a default constructed request_hooks to remove them.
+     * @param new_hooks The hooks to invoke.
+     */
+    auto hooks(const request_hooks& new_hooks) -> void { m_hooks = new_hooks; }
+
+    /**
+     * @return The state needed to resume parsing the current request later, see request_state.
+     *         Empty if more than 4 GiB of the data has been parsed, the offsets do not fit.
+     */
+    auto detach() const -> std::optional<request_state>;
+
+    /**
+     * Resets the parser and resumes the detached 'state', the uri, headers and body parsed so far
+     * are available again and parse() continues where the detached parser left off.  The hooks
+     * are kept and are not invoked for what was already parsed.
+     * @param state The state returned by detach().
+     * @param data The same data the state was detached from, more may have been appended.
+     */
+    auto attach(const request_state& state, std::string& data) -> void;
+
+    auto attach(const request_state& state, std::span<char> data) -> void;
+
+    /// A read-only attach(), see the read-only parse().
+    auto attach(const request_state& state, std::span<const char> data) -> void;
+
+    /**
+     * @return The size of the blob checkpoint() writes for the current state.
+     */
+    auto checkpoint_size() const -> std::size_t
+    {
+        return checkpoint_layout::size + m_header_count * checkpoint_layout::entry_size;
+    }
+
+    /**
+     * Writes the resumable state into a versioned little endian blob, see checkpoint.hpp, so a
+     * partially parsed request can be migrated to another thread or process and resumed there
+     * with restore() without parsing it again.
+     * @param blob At least checkpoint_size() bytes.
+     * @return The number of bytes written, 0 if the blob is too small or more than 4 GiB of the
+     *         data has been parsed, the offsets do not fit.
+     */
+    auto checkpoint(std::span<std::byte> blob) const -> std::size_t;
+
+    /**
+     * Resets the parser and resumes the request checkpointed in 'blob', see attach().  The blob
+     * is checked against the data before anything in it is used so a corrupt blob, a blob of
+     * another format version or a blob from different data cannot make the parser read outside
+     * of the data.
+     * @param blob The bytes written by checkpoint().
+     * @param data The same data the checkpoint was taken against, more may have been appended.
+     * @return True if the request was resumed, false if the blob was rejected and the parser is reset.
+     */
+    auto restore(std::span<const std::byte> blob, std::string& data) -> bool;
+
+    auto restore(std::span<const std::byte> blob, std::span<char> data) -> bool;
+
+    /// A read-only restore(), see the read-only parse().
+    auto restore(std::span<const std::byte> blob, std::span<const char> data) -> bool;
+
     /**
      * @return The current internal parse state (how far its gotten) for the current set of data.
      */
     auto state() const -> request_parse_state { return m_parse_state; }
 
+    /**
+     * @return The number of bytes of the data the request occupies, only valid once parsing is 'complete'.
+     *         Any data after this offset belongs to the next (pipelined) message.
+     */
+    auto bytes_consumed() const -> std::size_t { return m_pos; }
+
     /**
      * @return The parsed HTTP Method.  This value is only valid if the parser has successfully
      *          passed the 'PARSED_METHOD' parse state.
@@ -121,6 +360,90 @@ public:
      */
     auto http_uri() const -> std::string_view { return m_uri; };
 
+    /**
+     * @return The path of the URI, everything before the first '?' or '#' and after the scheme
+     *         and authority of an absolute-form uri, empty for an authority-form uri.  This value
+     *         is only valid if the parser has successfully passed the 'PARSED_URI' parse state.
+     */
+    auto http_path() const -> std::string_view
+    {
+        return m_uri.substr(m_uri_split.path_start, m_uri_split.path_end - m_uri_split.path_start);
+    }
+
+    /**
+     * @return The form of the URI, origin-form unless the request is for a proxy.  This value is
+     *         only valid if the parser has successfully passed the 'PARSED_URI' parse state.
+     */
+    auto http_target_form() const -> target_form { return m_uri_split.form; }
+
+    /**
+     * @return The scheme of an absolute-form URI without the "://", e.g. "http", otherwise empty.
+     */
+    auto http_scheme() const -> std::string_view
+    {
+        if(m_uri_split.form != target_form::absolute)
+        {
+            return std::string_view{};
+        }
+        return m_uri.substr(0, m_uri.find(':'));
+    }
+
+    /**
+     * @return The host of an absolute-form or authority-form URI, e.g. "example.com" or
+     *         "[::1]", otherwise empty.  It is not the Host header.
+     */
+    auto http_target_host() const -> std::string_view
+    {
+        return m_uri.substr(m_uri_split.host_start, m_uri_split.host_end - m_uri_split.host_start);
+    }
+
+    /**
+     * @return The port of an absolute-form or authority-form URI.  If an absolute-form URI has
+     *         none it is 80 for "http" and 443 for "https", otherwise 0.
+     */
+    auto http_target_port() const -> std::uint16_t { return m_uri_split.port; }
+
+    /**
+     * @return The query of the URI without the '?', empty if there is none.  This value is only
+     *         valid if the parser has successfully passed the 'PARSED_URI' parse state.
+     */
+    auto http_query() const -> std::string_view
+    {
+        if(m_uri_split.path_end >= m_uri.length() || m_uri[m_uri_split.path_end] != '?')
+        {
+            return std::string_view{};
+        }
+        return m_uri.substr(m_uri_split.path_end + 1, m_uri_split.query_end - m_uri_split.path_end - 1);
+    }
+
+    /**
+     * @return The fragment of the URI without the '#', empty if there is none.  This value is
+     *         only valid if the parser has successfully passed the 'PARSED_URI' parse state.
+     */
+    auto http_fragment() const -> std::string_view
+    {
+        if(m_uri_split.query_end >= m_uri.length())
+        {
+            return std::string_view{};
+        }
+        return m_uri.substr(m_uri_split.query_end + 1);
+    }
+
+    /**
+     * @return The parameters of the query, iterating yields each (key, value) pair undecoded.
+     */
+    auto http_query_params() const -> query_params { return query_params{http_query()}; }
+
+    /**
+     * Finds the first query parameter given by key (case sensitive), see query_params::find().
+     * @param key Find this parameter's value.
+     * @return The undecoded value if the query has the parameter, otherwise an empty optional.
+     */
+    auto http_query_param(std::string_view key) const -> std::optional<std::string_view>
+    {
+        return http_query_params().find(key);
+    }
+
     /**
      * @return The parsed HTTP Version.  This value is only valid if the parser has succesfully
      *          passed the 'PARSED_VERSION' parse state.
@@ -139,6 +462,26 @@ public:
      */
     auto http_header(std::string_view name) const -> std::optional<std::string_view>;
 
+    /**
+     * @return The first Host header without the port and the trailing dot of a fully qualified
+     *         name, e.g. "www.example.com" for "WWW.Example.com.:8080", for virtual host dispatch.
+     *         Lowercased in place when parsed from mutable data with parse(std::string&) or
+     *         parse(std::span<char>&), as it is in the data read-only, empty if there is none.
+     */
+    auto http_host() const -> std::string_view { return m_host.name; }
+
+    /**
+     * @return host_hash() of http_host(), computed while the Host header was parsed so the virtual
+     *         host is not hashed again per request.
+     */
+    auto http_host_hash() const -> std::uint64_t { return m_host.hash; }
+
+    /**
+     * @return http_host() with its hash, to look up a table keyed with host_hasher and host_equal
+     *         without hashing the host again.
+     */
+    auto http_host_key() const -> const host_split& { return m_host; }
+
     /**
      * Iterates over each request header with the (name, value) pair as std::string_view arguments.
      * @tparam Functor [](std::string_view name, std::string_view value) -> void;
@@ -159,36 +502,87 @@ public:
      */
     auto http_body() const -> const std::optional<std::string_view>& { return m_body; }
 
+    /**
+     * @return The chunks of a chunked body parsed with the read-only parse(), otherwise an empty
+     *         view.  Returned by value so it can be iterated directly in a range-for.
+     */
+    auto http_body_chunks() const -> body_chunks { return body_chunks{m_chunked_body}; }
+
+    /**
+     * @return How often the header names matched the previous request's, always zero unless the
+     *         policy's header_layout_bytes enables the cache.
+     */
+    auto header_layout_stats() const -> const http::header_layout_stats& { return m_header_layout.stats(); }
+
+    /**
+     * Copies the request into a single allocation from 'arena' so the data it was parsed from can
+     * be reused right away, e.g. an I/O thread handing the request to a worker thread.  The request
+     * line and header block are copied with one memcpy followed by the body, the uri, header and
+     * body views of the copy point into the allocation.  The copy can be read but not parsed any
+     * further.
+     * @param arena Typically a std::pmr::monotonic_buffer_resource owned by the worker.
+     * @return The copy.
+     */
+    auto clone_into(std::pmr::memory_resource& arena) const -> request;
+
+    /**
+     * @return The request's scratch memory for decoded values, only available when the policy's
+     *         arena_bytes is set.  Everything allocated from it is released by reset().
+     */
+    auto arena() -> request_arena<policy_type::arena_bytes>& requires (policy_type::arena_bytes > 0)
+    {
+        return m_arena;
+    }
+
 private:
-    /// How far in the parse state machine has this data gotten?
-    request_parse_state m_parse_state{request_parse_state::start};
-    /// The exact index of where the previous Parse() call was left off at.
-    std::size_t m_pos{0};
+    /// The SPMD engine fills the request directly from the offsets it found, see lanes.hpp.
+    friend class experimental::lane_engine<request>;
 
-    /// The parsed HTTP Method.
-    method m_method{method::get};
+    // The state read and written on every parse() call is packed together at the front so a
+    // resumed parse touches a single cache line (64 bytes) before it reaches the data, the parse
+    // results follow.
 
+    /// The exact index of where the previous Parse() call was left off at.
+    std::size_t m_pos{0};
+    /// The Content-Length value if present.
+    std::size_t m_content_length{0};
+    /// The start of the body (used for Transfer-Encoding: chunked)
+    std::size_t m_body_start{0};
     /// The starting position of the URI, saved during subsequent parses to calculate the full view.
     std::size_t m_uri_start_pos{0};
-    /// The parsed URI.
-    std::string_view m_uri{};
-
+    /// The starting position of the headers, used to enforce the policy's max_header_bytes.
+    std::size_t m_headers_start{0};
+    /// The number of headers in the request.
+    std::size_t m_header_count{0};
+    /// How far in the parse state machine has this data gotten?
+    request_parse_state m_parse_state{request_parse_state::start};
+    /// The type of body, if there is one.
+    body_type m_body_type{body_type::no_body};
+    /// The parsed HTTP Method.
+    method m_method{method::get};
     /// The parsed HTTP/X.Y version.
     version m_version{version::v1_1};
 
-    /// The number of headers in the request.
-    std::size_t m_header_count{0};
+    /// The parsed URI.
+    std::string_view m_uri{};
+    /// Where the URI splits into the path, query and fragment.
+    uri_split m_uri_split{};
+    /// The Host header split and hashed, see http_host().
+    host_split m_host{};
     /// The actual contents of the header values.
     std::array<std::pair<std::string_view, std::string_view>, header_count> m_headers{};
-
-    /// The type of body, if there is one.
-    body_type m_body_type{body_type::no_body};
-    /// The Content-Length value if present.
-    std::size_t m_content_length{0};
-    /// The start of the body (used for Transfer-Encoding: chunked)
-    std::size_t m_body_start{0};
     /// The request body contents if any.
     std::optional<std::string_view> m_body{};
+    /// The raw chunked body parsed so far by the read-only parse.
+    std::string_view m_chunked_body{};
+
+    /// The application hooks invoked while parsing.
+    request_hooks m_hooks{};
+
+    /// The header names of the previous request, kept across reset(), see the policy's header_layout_bytes.
+    [[no_unique_address]] header_layout<header_count, policy_type::header_layout_bytes> m_header_layout{};
+    /// The scratch memory for decoded values, see the policy's arena_bytes.
+    [[no_unique_address]] request_arena<policy_type::arena_bytes> m_arena{};
 };
 
 enum class response_parse_result
@@ -200,7 +594,12 @@ enum class response_parse_result
     http_version_unknown,
     http_status_code_malformed,
     maximum_headers_exceeded,
-    chunk_malformed
+    chunk_malformed,
+    header_malformed,
+    content_length_malformed,
+    headers_too_large,
+    header_value_too_long,
+    body_too_large
 };
 
 enum class response_parse_state
@@ -213,8 +612,35 @@ enum class response_parse_state
     parsed_body
 };
 
-template<std::size_t header_count = TURBOHTTP_HEADER_COUNT>
-class response
+/**
+ * The resumable state of a response detached from the parser with response::detach(), see request_state.
+ */
+struct response_state
+{
+    /// The Content-Length value, or the decoded length of a chunked body so far.
+    std::uint64_t content_length{0};
+    /// Where parsing continues from.
+    std::uint32_t pos{0};
+    /// The length of the reason phrase once parsed, it ends at the \r\n before the headers.
+    std::uint32_t reason_length{0};
+    /// The start of the headers.
+    std::uint32_t headers_start{0};
+    /// The start of a chunked body.
+    std::uint32_t body_start{0};
+    /// The status code.
+    std::uint16_t status_code{0};
+    /// The response_parse_state.
+    std::uint8_t parse_state{0};
+    /// The version.
+    std::uint8_t version{0};
+    /// The body_type.
+    std::uint8_t body_type{0};
+};
+
+static_assert(sizeof(response_state) == 32);
+
+template<std::size_t header_count = TURBOHTTP_HEADER_COUNT, typename policy_type = lenient_policy>
+class alignas(policy_type::parser_alignment) response
 {
 public:
     response() = default;
@@ -227,12 +653,30 @@ public:
 
     auto parse(std::string& data) -> response_parse_result;
     auto parse(std::span<char>& data) -> response_parse_result;
+    /// A read-only parse, see request::parse(std::span<const char>).
+    auto parse(std::span<const char> data) -> response_parse_result;
 private:
-    auto parse_version(std::span<char>& data) -> response_parse_result;
-    auto parse_status_code(std::span<char>& data) -> response_parse_result;
-    auto parse_reason_phrase(std::span<char>& data) -> response_parse_result;
-    auto parse_headers(std::span<char>& data) -> response_parse_result;
-    auto parse_body(std::span<char>& data) -> response_parse_result;
+    /// 'char_type' is 'const char' for the read-only parse.
+    template<typename char_type>
+    auto parse_impl(std::span<char_type> data) -> response_parse_result;
+    /// parse_impl() for dispatch_engine::computed_goto.
+    template<typename char_type>
+    auto parse_goto(std::span<char_type> data) -> response_parse_result;
+    /// Parses the status line and headers for dispatch_engine::dfa.
+    auto parse_head_dfa(std::span<const char> data) -> response_parse_result;
+
+    auto parse_version(std::span<const char> data) -> response_parse_result;
+    auto parse_status_code(std::span<const char> data) -> response_parse_result;
+    auto parse_reason_phrase(std::span<const char> data) -> response_parse_result;
+    auto parse_headers(std::span<const char> data) -> response_parse_result;
+    auto store_header(std::string_view name, std::string_view value) -> response_parse_result;
+    template<typename char_type>
+    auto parse_body(std::span<char_type> data) -> response_parse_result;
+    /// 'split_headers' is false when restore() sets the headers from the checkpoint instead.
+    template<typename char_type>
+    auto attach_impl(const response_state& state, std::span<char_type> data, bool split_headers) -> void;
+    template<typename char_type>
+    auto restore_impl(std::span<const std::byte> blob, std::span<char_type> data) -> bool;
 public:
 
     /**
@@ -240,11 +684,64 @@ public:
      */
     auto reset() -> void;
 
+    /**
+     * @return The state needed to resume parsing the current response later, see response_state.
+     *         Empty if more than 4 GiB of the data has been parsed, the offsets do not fit.
+     */
+    auto detach() const -> std::optional<response_state>;
+
+    /**
+     * Resets the parser and resumes the detached 'state', see request::attach().
+     * @param state The state returned by detach().
+     * @param data The same data the state was detached from, more may have been appended.
+     */
+    auto attach(const response_state& state, std::string& data) -> void;
+
+    auto attach(const response_state& state, std::span<char> data) -> void;
+
+    /// A read-only attach(), see the read-only parse().
+    auto attach(const response_state& state, std::span<const char> data) -> void;
+
+    /**
+     * @return The size of the blob checkpoint() writes for the current state.
+     */
+    auto checkpoint_size() const -> std::size_t
+    {
+        return checkpoint_layout::size + m_header_count * checkpoint_layout::entry_size;
+    }
+
+    /**
+     * Writes the resumable state into a versioned little endian blob, see request::checkpoint().
+     * @param blob At least checkpoint_size() bytes.
+     * @return The number of bytes written, 0 if the blob is too small or more than 4 GiB of the
+     *         data has been parsed, the offsets do not fit.
+     */
+    auto checkpoint(std::span<std::byte> blob) const -> std::size_t;
+
+    /**
+     * Resets the parser and resumes the response checkpointed in 'blob', see request::restore().
+     * @param blob The bytes written by checkpoint().
+     * @param data The same data the checkpoint was taken against, more may have been appended.
+     * @return True if the response was resumed, false if the blob was rejected and the parser is reset.
+     */
+    auto restore(std::span<const std::byte> blob, std::string& data) -> bool;
+
+    auto restore(std::span<const std::byte> blob, std::span<char> data) -> bool;
+
+    /// A read-only restore(), see the read-only parse().
+    auto restore(std::span<const std::byte> blob, std::span<const char> data) -> bool;
+
     /**
      * @return The current internal parse state (how far its gotten) for the current set of data.
      */
     auto state() const -> response_parse_state { return m_parse_state; }
 
+    /**
+     * @return The number of bytes of the data the response occupies, only valid once parsing is 'complete'.
+     *         Any data after this offset belongs to the next (pipelined) message.
+     */
+    auto bytes_consumed() const -> std::size_t { return m_pos; }
+
     /**
      * @return Gets the HTTP Version of the response.
      */
@@ -292,33 +789,43 @@ public:
      */
     auto http_body() const -> const std::optional<std::string_view>& { return m_body; }
 
+    /**
+     * @return The chunks of a chunked body parsed with the read-only parse(), otherwise an empty
+     *         view.  Returned by value so it can be iterated directly in a range-for.
+     */
+    auto http_body_chunks() const -> body_chunks { return body_chunks{m_chunked_body}; }
+
 
 private:
-    /// How far in the parse state machine has this data gotten?
-    response_parse_state m_parse_state{response_parse_state::start};
+    // The state read and written on every parse() call is packed together at the front, see request.
+
     /// The exact index of where the previous Parse() call was left off at.
     std::size_t m_pos{0};
-
+    /// The Content-Length value if present.
+    std::size_t m_content_length{0};
+    /// The start of the body (used for Transfer-Encoding: chunked)
+    std::size_t m_body_start{0};
+    /// The starting position of the headers, used to enforce the policy's max_header_bytes.
+    std::size_t m_headers_start{0};
+    /// The number of headers in the response.
+    std::size_t m_header_count{0};
+    /// How far in the parse state machine has this data gotten?
+    response_parse_state m_parse_state{response_parse_state::start};
+    /// The type of body, if there is one.
+    body_type m_body_type{body_type::no_body};
     /// The parsed HTTP/X.Y version.
     version m_version{version::v1_1};
+
     /// The HTTP response status code.
     uint64_t m_status_code{0};
     /// The HTTP Reason Phrase.
     std::string_view m_reason_phrase{};
-
-    /// The number of headers in the response.
-    std::size_t m_header_count{0};
     /// The actual contents of the header values.
     std::array<std::pair<std::string_view, std::string_view>, header_count> m_headers;
-
-    /// The type of body, if there is one.
-    body_type m_body_type{body_type::no_body};
-    /// The Content-Length value if present.
-    std::size_t m_content_length{0};
-    /// The start of the body (used for Transfer-Encoding: chunked)
-    std::size_t m_body_start{0};
     /// The response body contents if any.
     std::optional<std::string_view> m_body{};
+    /// The raw chunked body parsed so far by the read-only parse.
+    std::string_view m_chunked_body{};
 };
 
 } // namespace turbo::http
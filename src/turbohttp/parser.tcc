@@ -1,9 +1,14 @@
 #pragma once
 
 #include "turbohttp/parser.hpp"
+#include "turbohttp/dfa.hpp"
+#include "turbohttp/scan.hpp"
 
+#include <algorithm>
 #include <charconv>
 #include <cstring>
+#include <limits>
+#include <type_traits>
 
 #define TURBO_UNLIKELY(EXPR) __glibc_unlikely(EXPR)
 #define TURBO_LIKELY(EXPR) __glibc_likely(EXPR)
@@ -151,8 +156,12 @@ enum class parse_version_result
     advance
 };
 
+/**
+ * Parses "HTTP/X.Y" starting at 'm_pos', on success 'm_pos' is left on the 'Y' character.
+ * 'm_pos' is not modified if the data is incomplete.
+ */
 static auto parse_version_common(
-    std::span<char>& data,
+    std::span<const char> data,
     std::size_t& m_pos,
     version& m_version
 
@@ -188,351 +197,19 @@ static auto parse_version_common(
     return parse_version_result::advance;
 }
 
-template<typename parse_state, typename parse_result, std::size_t header_count>
-static auto parse_headers_common(
-    std::span<char>& data,
-    std::size_t& m_pos,
-    std::size_t& m_header_count,
-    std::array<std::pair<std::string_view, std::string_view>, header_count>& m_headers,
-    body_type& m_body_type,
-    std::size_t& m_content_length,
-    parse_state& m_parse_state
-) -> parse_result
-{
-    size_t data_length = data.size();
-    // missing empty line or headers
-    if(data_length == m_pos)
-    {
-        return parse_result::incomplete;
-    }
-
-    // If there are exactly 2 characters left and its the newline,
-    // this request is complete as there are no headers.
-    if(
-            m_pos + 2 <= data_length
-        &&  data[m_pos] == HTTP_CR
-        &&  data[m_pos + 1] == HTTP_LF
-        )
-    {
-        m_pos += 2; // advance twice for the consumed values.
-        return parse_result::advance;
-    }
-
-    // There must be some headers here, parse them!
-    while(true)
-    {
-        size_t name_start = m_pos;
-        size_t value_start;
-        size_t name_end = name_start;
-
-#define CHECK_FOR_COLON() { if(data[++name_end] == ':') break; }
-        // lets check 8 chars in a row!
-        while(name_end + 8 < data_length)
-        {
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-            CHECK_FOR_COLON();
-        }
-#undef CHECK_FOR_COLON
-
-        // go one by one...
-        while(true)
-        {
-            if(name_end < data_length)
-            {
-                if(data[name_end] == ':')
-                {
-                    value_start = name_end + 1;
-                    break; // while(true);
-                }
-                ++name_end;
-            }
-            else
-            {
-                return parse_result::incomplete;
-            }
-        }
-
-        // Currently std::string.find is not faster than the hand rolled loop.
-        // auto pos = data.find(':', name_end);
-        // if(TURBO_LIKELY(pos != std::string::npos))
-        // {
-        //     value_start = pos + 1; // Point to the first char after ':'.
-        //     name_end = pos;
-        // }
-        // else
-        // {
-        //     return parse_result::incomplete;
-        // }
-
-        // Walk value forwards to left trim, this is unlikely to be more than 1 HTTP_SP or HTTP_HTAB
-        while(value_start < data_length && is_http_ws(data[value_start]))
-        {
-            ++value_start;
-        }
-
-        // The parser has found the name of the header, now parse for the value.
-        size_t value_end = value_start;
-        if(!find_crlf(std::string_view{data.data(), data.size()}, value_end))
-        {
-            return parse_result::incomplete;
-        }
-
-        // Update the current position after finding the end of the header,
-        // since this loop expects to be on the first char its checking ADVANCE 3 times
-        m_pos = value_end + 3;
-
-        // Walk value end backwards to right trim
-        while(is_http_ws(data[value_end]))
-        {
-            --value_end;
-        }
-
-        // We are out of space :(
-        if(m_header_count == header_count)
-        {
-            return parse_result::maximum_headers_exceeded;
-        }
-
-        m_headers[m_header_count] =
-        {
-            {&data[name_start], (name_end - name_start)},
-            {&data[value_start], (value_end - value_start + 1)}
-        };
-        // Before continuing, check to see if any of these headers give an indication if
-        // there is any body content.
-        if(m_body_type == body_type::no_body)
-        {
-            auto& [name, value] = m_headers[m_header_count];
-            if(
-                    internal_string_view_iequal(name, "transfer-encoding")
-                &&  internal_string_view_iequal(value, "chunked")
-            )
-            {
-                m_body_type = body_type::chunked;
-            }
-            else if(
-                    internal_string_view_iequal(name, "content-length")
-                &&  value.length() > 0
-            )
-            {
-                m_content_length = 0; // in the event from_chars fails, we'll get no body
-                std::from_chars(value.data(), value.data() + value.length(), m_content_length, 10);
-                m_body_type = body_type::content_length;
-            }
-        }
-        ++m_header_count;
-
-        // If this header line end with CRLF then this request has no more headers.
-        if(
-                m_pos + 1 < data_length
-            &&  data[m_pos] == HTTP_CR
-            &&  data[m_pos + 1] == HTTP_LF
-        )
-        {
-            m_pos += 2; // ADVANCE two times for the consumed values and setup for next parse stage
-            m_parse_state = parse_state::parsed_headers;
-            break; // while(true)
-        }
-    }
-
-    return parse_result::advance;
-}
-
-template<typename parse_state, typename parse_result>
-static auto parse_body_common(
-    std::span<char>& data,
-    parse_state& m_parse_state,
+/**
+ * Parses the request method and the HTTP_SP that follows it, on success 'm_pos' is left on
+ * the first character of the URI.  'm_pos' is not modified if the data is incomplete.
+ */
+static auto parse_method_common(
+    std::span<const char> data,
     std::size_t& m_pos,
-    body_type& m_body_type,
-    std::size_t& m_body_start,
-    std::size_t& m_content_length,
-    std::optional<std::string_view>& m_body) -> parse_result
-{
-    size_t data_length = data.size();
-    switch(m_body_type)
-    {
-        case body_type::chunked:
-        {
-            // First time through record the start of the body for the full chunked body size.
-            if(!m_body.has_value())
-            {
-                m_body_start = m_pos;
-                m_content_length = 0; // leverage this for the decoded length
-                m_body.emplace(&data[m_pos], 0);
-            }
-
-            while(true)
-            {
-                size_t chunk_size_end = m_pos + 1;
-                bool chunk_size_end_found = false;
-                while(chunk_size_end + 1 < data_length)
-                {
-                    if(data[chunk_size_end] == HTTP_CR && data[chunk_size_end + 1] == HTTP_LF)
-                    {
-                        chunk_size_end_found = true;
-                        break; // while(chunk_size_end + 1 < data_length)
-                    }
-                    ++chunk_size_end;
-                }
-
-                if(!chunk_size_end_found)
-                {
-                    return parse_result::incomplete;
-                }
-
-                // Chunk lengths are on base 16 hex.
-                size_t chunk_length{0};
-                std::from_chars(&data[m_pos], &data[chunk_size_end], chunk_length, 16);
-
-                if(chunk_length != 0)
-                {
-                    // There is a valid chunk with some data, parse over it!
-                    // (note: chunk_size_end includes 1 byte for \r\n already
-                    m_pos = chunk_size_end + 1 + chunk_length;
-                    if(m_pos + 2 < data_length)
-                    {
-                        // move the data into the correct position. this is major YIKES!
-                        char* data_start = data.data() + (m_body_start + m_content_length);
-                        char* chunk_start = data.data() + (chunk_size_end + 2);
-
-                        std::memmove(data_start, chunk_start, chunk_length);
-                        m_content_length += chunk_length; // Keep track of the entire size though content length.
-                        m_body.emplace(&data[m_body_start], m_content_length);
-
-                        ADVANCE_EXPECT(HTTP_CR, parse_result::chunk_malformed);
-                        ADVANCE_EXPECT(HTTP_LF, parse_result::chunk_malformed);
-                        ADVANCE(); // This chunk parser expects to be on the first byte of the chunk
-                    }
-                }
-                else
-                {
-                    // If the chunk length is zero, then ADVANCE_EXPECT the final \r\n and record the body.
-                    if(chunk_size_end + 3 <= data_length) // need \n\r\n
-                    {
-                        m_pos = chunk_size_end + 1; // strip the \n trailing chunk_size_end
-                        ADVANCE_EXPECT(HTTP_CR, parse_result::chunk_malformed);
-                        ADVANCE_EXPECT(HTTP_LF, parse_result::chunk_malformed);
-                        m_parse_state = parse_state::parsed_body;
-                        break; // while(true)
-                    }
-                    else
-                    {
-                        // its possible to infer the last two bytes *should* be CR LF, but technically
-                        // it is incomplete without them
-                        return parse_result::incomplete;
-                    }
-                }
-            }
-        }
-            break;
-        case body_type::content_length:
-        {
-            if(m_pos + m_content_length >= data_length)
-            {
-                m_body.emplace(&data[m_pos], m_content_length);
-                m_parse_state = parse_state::parsed_body;
-            }
-            else
-            {
-                return parse_result::incomplete;
-            }
-        }
-            break;
-        case body_type::no_body:
-            // nothing to do
-            break;
-    }
-
-    return parse_result::complete;
-}
-
-template<std::size_t header_count>
-auto request<header_count>::parse(std::string& data) -> request_parse_result
-{
-    std::span<char> data_span{data.data(), data.length()};
-    return parse(data_span);
-}
-
-template<std::size_t header_count>
-auto request<header_count>::parse(std::span<char>& data) -> request_parse_result
-{
-    if(data.empty())
-    {
-        return request_parse_result::incomplete;
-    }
-
-    if(m_parse_state == request_parse_state::start)
-    {
-        auto result = parse_method(data);
-        if(result != request_parse_result::advance)
-        {
-            return result;
-        }
-    }
-
-    // After parsing the Method move on to parsing the URI.
-    if(m_parse_state == request_parse_state::parsed_method)
-    {
-        auto result = parse_uri(data);
-        if(result != request_parse_result::advance)
-        {
-            return result;
-        }
-    }
-
-    if(m_parse_state == request_parse_state::parsed_uri)
-    {
-        auto result = parse_version(data);
-        if(result != request_parse_result::advance)
-        {
-            return result;
-        }
-    }
-
-    if(m_parse_state == request_parse_state::parsed_version)
-    {
-        auto result = parse_headers(data);
-        if(result != request_parse_result::advance)
-        {
-            return result;
-        }
-    }
-
-    /**
-     * Its possible there is a body after the headers, but this parser only supports
-     * it if it can deduce how long the body is by either having a content-length header
-     * or chunked encoding.  End of stream is technically a valid http request but
-     * without access to the socket the parser has no way of knowing if its the end or,
-     * thus we'll just report completion upon finishing parsing of the headers.
-     */
-    if(    m_parse_state == request_parse_state::parsed_headers
-        && m_body_type != body_type::no_body
-    )
-    {
-        auto result = parse_body(data);
-        if(result != request_parse_result::advance)
-        {
-            return result;
-        }
-    }
-
-    // Currently does not support trailing headers.
-
-    return request_parse_result::complete;
-}
-
-template<std::size_t header_count>
-auto request<header_count>::parse_method(std::span<char>& data) -> request_parse_result
+    method& m_method
+) -> request_parse_result
 {
     size_t data_length = data.size();
 
-    switch(data[0])
+    switch(data[m_pos])
     {
         // GET
         case 'G':
@@ -559,14 +236,15 @@ auto request<header_count>::parse_method(std::span<char>& data) -> request_parse
             // we need to guarantee 1 character for which P method this is
             if(m_pos + 1 < data_length)
             {
-                // Only advance once for this check, since its multiple branches.
-                switch(data[++m_pos])
+                // Peek at the second character without advancing, the data could still be incomplete.
+                switch(data[m_pos + 1])
                 {
                     case 'O':
                     {
                         // "PO" "ST "
-                        if(m_pos + 3 < data_length)
+                        if(m_pos + 4 < data_length)
                         {
+                            ADVANCE();
                             ADVANCE_EXPECT('S', request_parse_result::method_unknown);
                             ADVANCE_EXPECT('T', request_parse_result::method_unknown);
                             ADVANCE_EXPECT(HTTP_SP, request_parse_result::method_unknown);
@@ -581,8 +259,9 @@ auto request<header_count>::parse_method(std::span<char>& data) -> request_parse
                     case 'U':
                     {
                         // "PU" "T "
-                        if(m_pos + 2 < data_length)
+                        if(m_pos + 3 < data_length)
                         {
+                            ADVANCE();
                             ADVANCE_EXPECT('T', request_parse_result::method_unknown);
                             ADVANCE_EXPECT(HTTP_SP, request_parse_result::method_unknown);
                             m_method = method::put;
@@ -596,8 +275,9 @@ auto request<header_count>::parse_method(std::span<char>& data) -> request_parse
                     case 'A':
                     {
                         // "PA" "TCH "
-                        if(m_pos + 4 < data_length)
+                        if(m_pos + 5 < data_length)
                         {
+                            ADVANCE();
                             ADVANCE_EXPECT('T', request_parse_result::method_unknown);
                             ADVANCE_EXPECT('C', request_parse_result::method_unknown);
                             ADVANCE_EXPECT('H', request_parse_result::method_unknown);
@@ -611,7 +291,7 @@ auto request<header_count>::parse_method(std::span<char>& data) -> request_parse
                     }
                         break;
                     default:
-                        return request_parse_result::incomplete;
+                        return request_parse_result::method_unknown;
                 }
             }
             else
@@ -725,65 +405,298 @@ auto request<header_count>::parse_method(std::span<char>& data) -> request_parse
             return request_parse_result::method_unknown;
     }
 
-    // If the parser gets this far then its successfully parsed the HTTP Method.
-    m_parse_state = request_parse_state::parsed_method;
+    // If the parser gets this far then its successfully parsed the HTTP Method,
+    // move past the HTTP_SP onto the first character of the URI.
+    ADVANCE();
 
     return request_parse_result::advance;
 }
 
-template<std::size_t header_count>
-auto request<header_count>::parse_uri(std::span<char>& data) -> request_parse_result
+/**
+ * Splits the scheme, host and port off an absolute-form or authority-form uri (RFC 9112 3.2)
+ * once its 'path_end' is known, only the bytes before the path are looked at.  An origin-form uri
+ * costs a single compare.  A userinfo ("user@") before the host of an absolute-form uri is
+ * skipped.  Nothing is split if the authority is malformed, the uri is left as an origin-form uri.
+ * @return False if the authority is malformed: an empty host, an unterminated IPv6 literal or a
+ *         port that is not a number up to 65535, or an authority-form uri without a port or
+ *         with anything after it.
+ */
+static auto split_target_common(std::string_view uri, uri_split& m_uri_split) -> bool
 {
-    ADVANCE(); // Previous parse leaves us on the HTTP_SP token before the URI, advance past it.
-    size_t data_length = data.size();
-    if(m_uri_start_pos == 0)
+    if(uri.empty() || uri[0] == '/')
     {
-        // Set the start pos once (subsequent Parse calls could have different m_pos!)
-        // saved for calculating the view of the URI.
-        m_uri_start_pos = m_pos;
+        return true;
+    }
+    if(uri == "*")
+    {
+        m_uri_split.form = target_form::asterisk;
+        return true;
     }
 
-    // Advance until the next HTTP_SP is found
-    while(true)
+    const std::size_t length = uri.length();
+    const std::size_t path_end = m_uri_split.path_end;
+
+    // scheme = ALPHA *( ALPHA / DIGIT / "+" / "-" / "." ), an authority-form host stops the same way.
+    std::size_t scheme_end = 0;
+    if(is_ascii_alpha(static_cast<unsigned char>(uri[0])))
     {
-        if(m_pos < data_length)
-        {
-            if(data[m_pos] != HTTP_SP)
-            {
-                // only advance if we don't find the HTTP_SP
-                ADVANCE();
-                continue; // while(true)
+        scheme_end = find_first<false>(uri.data(), 1, path_end, scheme_class);
+    }
+
+    target_form form = target_form::authority;
+    std::size_t authority_start = 0;
+    if(scheme_end > 0 && uri.substr(scheme_end, 3) == "://")
+    {
+        form = target_form::absolute;
+        authority_start = scheme_end + 3;
+    }
+
+    // One pass over the authority jumps between the delimiters to find where it ends at the path
+    // (or the query or fragment if there is no path), the last '@' and the first ':' and ']' after it.
+    constexpr std::size_t none = std::string_view::npos;
+    std::size_t at = none;
+    std::size_t colon = none;
+    std::size_t close = none;
+    std::size_t authority_end = authority_start;
+    while((authority_end = find_first<true>(uri.data(), authority_end, path_end, authority_delimiter_class)) < path_end)
+    {
+        char c = uri[authority_end];
+        if(c == '/')
+        {
+            break;
+        }
+        if(c == '@')
+        {
+            at = authority_end;
+            colon = none;
+            close = none;
+        }
+        else if(c == ':' && colon == none)
+        {
+            colon = authority_end;
+        }
+        else if(c == ']' && close == none)
+        {
+            close = authority_end;
+        }
+        ++authority_end;
+    }
+    if(form == target_form::authority && (authority_end != length || at != none))
+    {
+        return false;
+    }
+
+    // The port follows the host, an IPv6 literal's colons are inside its brackets.
+    std::size_t host_start = (at == none) ? authority_start : at + 1;
+    std::size_t host_end = (colon == none) ? authority_end : colon;
+    if(host_start < authority_end && uri[host_start] == '[')
+    {
+        if(close == none)
+        {
+            return false;
+        }
+        host_end = close + 1;
+        if(host_end < authority_end && uri[host_end] != ':')
+        {
+            return false;
+        }
+    }
+    if(host_end == host_start)
+    {
+        return false;
+    }
+
+    std::uint32_t port = 0;
+    if(host_end < authority_end)
+    {
+        // An empty port ("host:") is the same as no port.
+        if(authority_end - host_end - 1 > 5)
+        {
+            return false;
+        }
+        for(std::size_t i = host_end + 1; i < authority_end; ++i)
+        {
+            if(!is_ascii_digit(static_cast<unsigned char>(uri[i])))
+            {
+                return false;
             }
-            else
+            port = port * 10 + static_cast<std::uint32_t>(uri[i] - '0');
+        }
+        if(port > 65535)
+        {
+            return false;
+        }
+    }
+    if(form == target_form::authority && port == 0)
+    {
+        return false;
+    }
+    if(port == 0)
+    {
+        auto scheme = uri.substr(0, scheme_end);
+        port = internal_string_view_iequal(scheme, "http") ? 80 : internal_string_view_iequal(scheme, "https") ? 443 : 0;
+    }
+
+    m_uri_split.form = form;
+    m_uri_split.path_start = static_cast<std::uint32_t>(form == target_form::absolute ? authority_end : length);
+    m_uri_split.host_start = static_cast<std::uint32_t>(host_start);
+    m_uri_split.host_end = static_cast<std::uint32_t>(host_end);
+    m_uri_split.port = static_cast<std::uint16_t>(port);
+    return true;
+}
+
+/**
+ * Parses the request URI up to the HTTP_SP that follows it, on success 'm_pos' is left on the
+ * first character of the HTTP version.  Scanning stops with 'uri_too_long' as soon as the uri
+ * is longer than the policy's max_uri_length.  If 'm_uri_split' is given the first '?' and '#'
+ * are recorded in the same scan, the scan stops on them as well as on the HTTP_SP.
+ */
+template<typename policy_type>
+static auto parse_uri_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    std::size_t& m_uri_start_pos,
+    std::string_view& m_uri,
+    uri_split* m_uri_split = nullptr
+) -> request_parse_result
+{
+    size_t data_length = data.size();
+    if(m_uri_start_pos == 0)
+    {
+        // Set the start pos once (subsequent Parse calls could have different m_pos!)
+        // saved for calculating the view of the URI.
+        m_uri_start_pos = m_pos;
+    }
+
+    // Only scan as far as the HTTP_SP could be for a uri of the maximum length.
+    size_t scan_end = data_length;
+    bool limited = false;
+    if constexpr(policy_type::max_uri_length != no_limit)
+    {
+        if(data_length - m_uri_start_pos > policy_type::max_uri_length)
+        {
+            scan_end = m_uri_start_pos + policy_type::max_uri_length + 1;
+            limited = true;
+        }
+    }
+
+    while(true)
+    {
+        if constexpr(policy_type::strict)
+        {
+            // Every byte up to the HTTP_SP must be a valid uri character.
+            m_pos = find_first<false>(data.data(), m_pos, scan_end, (m_uri_split != nullptr) ? uri_split_class : uri_class);
+            if(m_pos == scan_end)
             {
-                // We've found the end of the URI.
-                break; // while(true)
+                if(limited)
+                {
+                    return request_parse_result::uri_too_long;
+                }
+                // If the end of the data is found with no HTTP_SP then more data is needed.
+                return request_parse_result::incomplete;
             }
         }
         else
         {
-            // If the end of the data is found with no HTTP_SP then more data is needed.
-            return request_parse_result::incomplete;
+            if(m_uri_split != nullptr && m_uri_split->query_end == uri_split::unsplit)
+            {
+                // The '?' and '#' are found in the same pass as the HTTP_SP.
+                m_pos = find_any(data.data(), m_pos, scan_end, HTTP_SP, '?', '#');
+            }
+            else
+            {
+                // Advance until the next HTTP_SP is found, memchr is vectorized.
+                auto* found = static_cast<const char*>(std::memchr(data.data() + m_pos, HTTP_SP, scan_end - m_pos));
+                m_pos = (found == nullptr) ? scan_end : static_cast<std::size_t>(found - data.data());
+            }
+            if(m_pos == scan_end)
+            {
+                if(limited)
+                {
+                    return request_parse_result::uri_too_long;
+                }
+                // If the end of the data is found with no HTTP_SP then more data is needed.
+                m_pos = data_length;
+                return request_parse_result::incomplete;
+            }
+        }
+
+        char c = data[m_pos];
+        if(m_uri_split == nullptr || (c != '?' && c != '#'))
+        {
+            break;
+        }
+
+        auto offset = static_cast<std::uint32_t>(m_pos - m_uri_start_pos);
+        if(m_uri_split->path_end == uri_split::unsplit)
+        {
+            m_uri_split->path_end = offset;
+        }
+        if(c == '#' && m_uri_split->query_end == uri_split::unsplit)
+        {
+            m_uri_split->query_end = offset;
         }
+        ADVANCE();
     }
 
-    // Subtract off 1 for the final HTTP_SP that was found.
-    m_uri = std::string_view{&data[m_uri_start_pos], m_pos - m_uri_start_pos};
+    if constexpr(policy_type::strict)
+    {
+        if(data[m_pos] != HTTP_SP || m_pos == m_uri_start_pos)
+        {
+            return request_parse_result::uri_malformed;
+        }
+    }
 
-    // If the parser gets this far then its successfully parsed the URI.
-    m_parse_state = request_parse_state::parsed_uri;
+    m_uri = std::string_view{&data[m_uri_start_pos], m_pos - m_uri_start_pos};
+    if(m_uri_split != nullptr)
+    {
+        auto length = static_cast<std::uint32_t>(m_uri.length());
+        m_uri_split->path_end = std::min(m_uri_split->path_end, length);
+        m_uri_split->query_end = std::min(m_uri_split->query_end, length);
+        if(!split_target_common(m_uri, *m_uri_split) && policy_type::strict)
+        {
+            return request_parse_result::uri_malformed;
+        }
+    }
+    ADVANCE(); // Move past the HTTP_SP onto the HTTP version.
 
     return request_parse_result::advance;
 }
 
-template<std::size_t header_count>
-auto request<header_count>::parse_version(std::span<char>& data) -> request_parse_result
+/**
+ * Splits an already parsed uri for the engines that find its end without scanning it, see uri_split.
+ * @return False if the authority of an absolute-form or authority-form uri is malformed.
+ */
+static auto split_uri_common(std::string_view uri, uri_split& m_uri_split) -> bool
 {
-    ADVANCE(); // the standalone function expects to be on the first character.
+    std::size_t path_end = find_any(uri.data(), 0, uri.length(), '?', '#', '#');
+    std::size_t query_end = path_end;
+    if(path_end < uri.length() && uri[path_end] == '?')
+    {
+        query_end = find_any(uri.data(), path_end, uri.length(), '#', '#', '#');
+    }
+    m_uri_split.path_end = static_cast<std::uint32_t>(path_end);
+    m_uri_split.query_end = static_cast<std::uint32_t>(query_end);
+    return split_target_common(uri, m_uri_split);
+}
 
-    auto result = parse_version_common(data, m_pos, m_version);
+/**
+ * Parses the request "HTTP/X.Y\r\n", on success 'm_pos' is left on the first character of the headers.
+ * 'm_pos' is not modified if the data is incomplete.
+ */
+static auto parse_request_version_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    version& m_version
+) -> request_parse_result
+{
+    // Wait for the entire "HTTP/X.Y\r\n" so a partial parse never has to be rolled back.
+    if(TURBO_UNLIKELY(m_pos + 9 >= data.size()))
+    {
+        return request_parse_result::incomplete;
+    }
 
-    switch(result)
+    switch(parse_version_common(data, m_pos, m_version))
     {
         case parse_version_result::malformed:
             return request_parse_result::http_version_malformed;
@@ -793,74 +706,1847 @@ auto request<header_count>::parse_version(std::span<char>& data) -> request_pars
             return request_parse_result::incomplete;
         case parse_version_result::advance:
         {
-            if (TURBO_UNLIKELY(m_pos + 2 >= data.size()))
-            {
-                return request_parse_result::incomplete;
-            }
-            else
-            {
-                // Need to also check for trailing \r\n in requests
-                ADVANCE_EXPECT(HTTP_CR, request_parse_result::http_version_malformed);
-                ADVANCE_EXPECT(HTTP_LF, request_parse_result::http_version_malformed);
-                ADVANCE(); // Next section expects to be on its starting position
-            }
-
-            m_parse_state = request_parse_state::parsed_version;
+            // Need to also check for trailing \r\n in requests
+            ADVANCE_EXPECT(HTTP_CR, request_parse_result::http_version_malformed);
+            ADVANCE_EXPECT(HTTP_LF, request_parse_result::http_version_malformed);
+            ADVANCE(); // Next section expects to be on its starting position
             return request_parse_result::advance;
         }
     }
-
-    // impossible but gcc complains
-    return request_parse_result::http_version_unknown;
+
+    // impossible but gcc complains
+    return request_parse_result::http_version_unknown;
+}
+
+/**
+ * Parses the response "HTTP/X.Y ", on success 'm_pos' is left on the first character of the status code.
+ * 'm_pos' is not modified if the data is incomplete.
+ */
+static auto parse_response_version_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    version& m_version
+) -> response_parse_result
+{
+    // Wait for the entire "HTTP/X.Y " so a partial parse never has to be rolled back.
+    if(TURBO_UNLIKELY(m_pos + 8 >= data.size()))
+    {
+        return response_parse_result::incomplete;
+    }
+
+    switch(parse_version_common(data, m_pos, m_version))
+    {
+        case parse_version_result::malformed:
+            return response_parse_result::http_version_malformed;
+        case parse_version_result::unknown:
+            return response_parse_result::http_version_unknown;
+        case parse_version_result::incomplete:
+            return response_parse_result::incomplete;
+        case parse_version_result::advance:
+        {
+            ADVANCE_EXPECT(HTTP_SP, response_parse_result::http_version_malformed);
+            ADVANCE();
+            return response_parse_result::advance;
+        }
+    }
+
+    // impossible gcc error
+    return response_parse_result::http_version_unknown;
+}
+
+/**
+ * Parses the 3 digit status code and the HTTP_SP that follows it, on success 'm_pos' is left
+ * on the first character of the reason phrase.  'm_pos' is not modified if the data is incomplete.
+ */
+static auto parse_status_code_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    uint64_t& m_status_code
+) -> response_parse_result
+{
+    size_t data_length = data.size();
+    size_t required_bytes = m_pos + 3;
+
+    /**
+     * All status codes are 3 digits in length, plus the trailing HTTP_SP, "XXX "
+     */
+    if(TURBO_UNLIKELY(required_bytes >= data_length))
+    {
+        return response_parse_result::incomplete;
+    }
+
+    if(    !std::isdigit(data[m_pos])
+        || !std::isdigit(data[m_pos + 1])
+        || !std::isdigit(data[m_pos + 2])
+    )
+    {
+        return response_parse_result::http_status_code_malformed;
+    }
+
+    std::from_chars(&data[m_pos], &data[required_bytes], m_status_code, 10);
+    if(TURBO_LIKELY(m_status_code != 0))
+    {
+        m_pos += 3; // Advanced 3x past the status code.
+        EXPECT(HTTP_SP, response_parse_result::http_status_code_malformed);
+        ADVANCE();
+        return response_parse_result::advance;
+    }
+    else
+    {
+        return response_parse_result::http_status_code_malformed;
+    }
+}
+
+/**
+ * Parses the reason phrase up to and including the \r\n that ends the status line, on success
+ * 'm_pos' is left on the first character of the headers.
+ */
+static auto parse_reason_phrase_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    std::string_view& m_reason_phrase
+) -> response_parse_result
+{
+    // Since the reason phrases are not truely standardized, the parser just looks
+    // for the \r\n that ends the line and sets the m_reason_phrase to the entire section.
+    // Its possible there are only certain characters allowed in the reason phrase, this is
+    // currently not handled by the parser and just looks for \r\n.
+
+    size_t value_end = m_pos;
+    if(TURBO_LIKELY(find_crlf(std::string_view{data.data(), data.size()}, value_end)))
+    {
+        // If found, value_end will be the byte before \r\n, so calculate the length + 1 for the string view.
+        m_reason_phrase = std::string_view{&data[m_pos], value_end - m_pos + 1};
+        m_pos = value_end + 3; // advance past the \r\n as well
+        return response_parse_result::advance;
+    }
+    else
+    {
+        return response_parse_result::incomplete;
+    }
+}
+
+/**
+ * The lenient_policy check for the headers that give an indication if there is any body content,
+ * the first Transfer-Encoding: chunked or Content-Length header wins.
+ */
+static auto detect_body_type_lenient(
+    std::string_view name,
+    std::string_view value,
+    body_type& m_body_type,
+    std::size_t& m_content_length
+) -> void
+{
+    if(m_body_type != body_type::no_body)
+    {
+        return;
+    }
+
+    if(
+            internal_string_view_iequal(name, "transfer-encoding")
+        &&  internal_string_view_iequal(value, "chunked")
+    )
+    {
+        m_body_type = body_type::chunked;
+    }
+    else if(
+            internal_string_view_iequal(name, "content-length")
+        &&  value.length() > 0
+    )
+    {
+        m_content_length = 0; // in the event from_chars fails, we'll get no body
+        std::from_chars(value.data(), value.data() + value.length(), m_content_length, 10);
+        m_body_type = body_type::content_length;
+    }
+}
+
+/// The largest Content-Length strict_policy frames, no object and so no body view can be larger.
+inline constexpr std::size_t max_framed_content_length = static_cast<std::size_t>(std::numeric_limits<std::ptrdiff_t>::max());
+
+/**
+ * The strict_policy check for the headers that give an indication if there is any body content.
+ * Every framing header is checked, conflicting values are a request smuggling vector.  A
+ * Content-Length over max_framed_content_length can never be framed and is malformed.
+ */
+template<typename parse_result>
+static auto detect_body_type_strict(
+    std::string_view name,
+    std::string_view value,
+    body_type& m_body_type,
+    std::size_t& m_content_length
+) -> parse_result
+{
+    if(internal_string_view_iequal(name, "content-length"))
+    {
+        size_t content_length{0};
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.length(), content_length, 10);
+        if(
+                value.empty()
+            ||  ec != std::errc{}
+            ||  ptr != value.data() + value.length()
+            ||  content_length > max_framed_content_length
+            ||  m_body_type == body_type::chunked
+            ||  (m_body_type == body_type::content_length && content_length != m_content_length)
+        )
+        {
+            return parse_result::content_length_malformed;
+        }
+        m_content_length = content_length;
+        m_body_type = body_type::content_length;
+    }
+    else if(
+            internal_string_view_iequal(name, "transfer-encoding")
+        &&  internal_string_view_iequal(value, "chunked")
+    )
+    {
+        if(m_body_type == body_type::content_length)
+        {
+            return parse_result::content_length_malformed;
+        }
+        m_body_type = body_type::chunked;
+    }
+
+    return parse_result::advance;
+}
+
+/**
+ * The name_functor of parse_headers_common() for parsers without a learned header layout.
+ */
+struct no_name_prediction
+{
+    auto operator()(std::span<const char>, std::size_t) const -> std::size_t { return std::string_view::npos; }
+};
+
+/**
+ * Parses the header lines, each parsed header is handed to 'on_header' to be stored.  The header
+ * block starting at 'headers_start' is never scanned past the policy's max_header_bytes and a
+ * single value is never scanned past the policy's max_header_value_length.
+ * @tparam header_functor [](std::string_view name, std::string_view value) -> parse_result;
+ *                        Returns 'advance' to continue parsing, any other value stops parsing
+ *                        and is returned to the caller.
+ * @tparam name_functor [](std::span<const char> data, std::size_t name_start) -> std::size_t;
+ *                      Returns the position of the ':' ending the name starting at 'name_start'
+ *                      if it is already known, otherwise std::string_view::npos and the name is
+ *                      scanned for, see header_layout.
+ */
+template<typename policy_type, typename parse_state, typename parse_result, typename header_functor, typename name_functor = no_name_prediction>
+static auto parse_headers_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    std::size_t headers_start,
+    bool has_headers,
+    body_type& m_body_type,
+    std::size_t& m_content_length,
+    parse_state& m_parse_state,
+    header_functor&& on_header,
+    name_functor&& predict_name_end = name_functor{}
+) -> parse_result
+{
+    // Scanning is limited to the maximum header block, running out of data inside of this limited
+    // window means the headers are too large rather than incomplete.
+    size_t data_length = data.size();
+    if constexpr(policy_type::max_header_bytes != no_limit)
+    {
+        if(data_length - headers_start > policy_type::max_header_bytes)
+        {
+            data_length = headers_start + policy_type::max_header_bytes;
+        }
+    }
+    auto incomplete = [&]() -> parse_result
+    {
+        return (data_length != data.size()) ? parse_result::headers_too_large : parse_result::incomplete;
+    };
+
+    while(true)
+    {
+        // missing empty line or headers, two bytes are needed to tell them apart
+        if(m_pos + 1 >= data_length)
+        {
+            return incomplete();
+        }
+
+        // The empty line ends the headers.
+        if(data[m_pos] == HTTP_CR && data[m_pos + 1] == HTTP_LF)
+        {
+            m_pos += 2; // ADVANCE two times for the consumed values and setup for next parse stage
+            // A message without any headers remains in its previous parse state.
+            if(has_headers)
+            {
+                m_parse_state = parse_state::parsed_headers;
+            }
+            break; // while(true)
+        }
+
+        size_t name_start = m_pos;
+        size_t value_start;
+        size_t name_end = predict_name_end(data.first(data_length), name_start);
+
+        if(name_end != std::string_view::npos)
+        {
+            value_start = name_end + 1;
+        }
+        else if constexpr(policy_type::strict)
+        {
+            // The name must be a token immediately followed by ':', this also rejects obs-fold
+            // continuation lines since they start with HTTP_SP or HTTP_HTAB.
+            name_end = find_first<false>(data.data(), name_start, data_length, tchar_class);
+            if(name_end == data_length)
+            {
+                return incomplete();
+            }
+            if(data[name_end] != ':' || name_end == name_start)
+            {
+                return parse_result::header_malformed;
+            }
+            value_start = name_end + 1;
+        }
+        else
+        {
+            name_end = name_start;
+#define CHECK_FOR_COLON() { if(data[name_end] == ':') break; ++name_end; }
+            // lets check 8 chars in a row!
+            while(name_end + 8 < data_length)
+            {
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+                CHECK_FOR_COLON();
+            }
+#undef CHECK_FOR_COLON
+
+            // go one by one...
+            while(true)
+            {
+                if(name_end < data_length)
+                {
+                    if(data[name_end] == ':')
+                    {
+                        value_start = name_end + 1;
+                        break; // while(true);
+                    }
+                    ++name_end;
+                }
+                else
+                {
+                    return incomplete();
+                }
+            }
+
+            // Currently std::string.find is not faster than the hand rolled loop.
+            // auto pos = data.find(':', name_end);
+            // if(TURBO_LIKELY(pos != std::string::npos))
+            // {
+            //     value_start = pos + 1; // Point to the first char after ':'.
+            //     name_end = pos;
+            // }
+            // else
+            // {
+            //     return parse_result::incomplete;
+            // }
+        }
+
+        // Walk value forwards to left trim, this is unlikely to be more than 1 HTTP_SP or HTTP_HTAB
+        while(value_start < data_length && is_http_ws(data[value_start]))
+        {
+            ++value_start;
+        }
+
+        // The parser has found the name of the header, now parse for the value.  Only scan as
+        // far as the \r\n could be for a value of the maximum length.
+        size_t value_scan_end = data_length;
+        bool value_limited = false;
+        if constexpr(policy_type::max_header_value_length != no_limit)
+        {
+            if(data_length - value_start > policy_type::max_header_value_length)
+            {
+                value_scan_end = value_start + policy_type::max_header_value_length + 1;
+                value_limited = true;
+            }
+        }
+
+        size_t value_end = value_start;
+        if constexpr(policy_type::strict)
+        {
+            // The first byte not allowed in a value must be the \r\n that ends the line.
+            value_end = find_first<true>(data.data(), value_start, value_scan_end, field_invalid_class);
+            if(value_end == value_scan_end && value_limited)
+            {
+                return parse_result::header_value_too_long;
+            }
+            if(value_end < data_length && data[value_end] != HTTP_CR)
+            {
+                return parse_result::header_malformed;
+            }
+            if(value_end + 1 >= data_length)
+            {
+                return incomplete();
+            }
+            if(data[value_end + 1] != HTTP_LF)
+            {
+                return parse_result::header_malformed;
+            }
+            --value_end; // value_end should point at the last char in the header.
+        }
+        else
+        {
+            // The \r\n can start on the last byte of the scan, its HTTP_LF may not have arrived yet.
+            size_t crlf_scan_end = (value_scan_end < data_length) ? value_scan_end + 1 : data_length;
+            if(!find_crlf(std::string_view{data.data(), crlf_scan_end}, value_end))
+            {
+                if(value_limited && !(value_scan_end == data_length && data[value_scan_end - 1] == HTTP_CR))
+                {
+                    return parse_result::header_value_too_long;
+                }
+                return incomplete();
+            }
+        }
+
+        // Update the current position after finding the end of the header,
+        // since this loop expects to be on the first char its checking ADVANCE 3 times
+        m_pos = value_end + 3;
+
+        // Walk value end backwards to right trim, an all whitespace value ends up empty.
+        while(value_end >= value_start && is_http_ws(data[value_end]))
+        {
+            --value_end;
+        }
+
+        std::string_view name{&data[name_start], (name_end - name_start)};
+        std::string_view value{&data[value_start], (value_end - value_start + 1)};
+
+        auto result = on_header(name, value);
+        if(result != parse_result::advance)
+        {
+            return result;
+        }
+
+        // Before continuing, check to see if any of these headers give an indication if
+        // there is any body content.
+        if constexpr(policy_type::strict)
+        {
+            result = detect_body_type_strict<parse_result>(name, value, m_body_type, m_content_length);
+            if(result != parse_result::advance)
+            {
+                return result;
+            }
+        }
+        else
+        {
+            detect_body_type_lenient(name, value, m_body_type, m_content_length);
+        }
+
+        has_headers = true;
+    }
+
+    return parse_result::advance;
+}
+
+/**
+ * Parses the body, each complete piece of the body is handed to 'on_body'.  A Content-Length body
+ * is a single piece, a chunked body is handed over one chunk at a time and never includes the
+ * chunk framing.  On completion 'm_pos' is left one past the end of the body.  For a chunked body
+ * 'm_content_length' is the decoded length of the chunks handed to 'on_body' so far, it must
+ * start at 0.  A body larger than the policy's max_body_length stops with 'body_too_large' before
+ * waiting for its data to arrive.
+ * @tparam body_functor [](std::size_t offset, std::size_t length) -> parse_result;
+ *                      'offset' is the index into 'data' of the piece.  Returns 'advance' to
+ *                      continue parsing, any other value stops parsing and is returned to the caller.
+ */
+template<typename policy_type, typename parse_state, typename parse_result, typename body_functor>
+static auto parse_body_common(
+    std::span<const char> data,
+    parse_state& m_parse_state,
+    std::size_t& m_pos,
+    body_type& m_body_type,
+    std::size_t& m_content_length,
+    body_functor&& on_body) -> parse_result
+{
+    size_t data_length = data.size();
+    switch(m_body_type)
+    {
+        case body_type::chunked:
+        {
+            while(true)
+            {
+                size_t chunk_size_end = m_pos + 1;
+                bool chunk_size_end_found = false;
+                while(chunk_size_end + 1 < data_length)
+                {
+                    if(data[chunk_size_end] == HTTP_CR && data[chunk_size_end + 1] == HTTP_LF)
+                    {
+                        chunk_size_end_found = true;
+                        break; // while(chunk_size_end + 1 < data_length)
+                    }
+                    ++chunk_size_end;
+                }
+
+                if(!chunk_size_end_found)
+                {
+                    return parse_result::incomplete;
+                }
+
+                // Chunk lengths are on base 16 hex.
+                size_t chunk_length{0};
+                [[maybe_unused]] auto [ptr, ec] = std::from_chars(&data[m_pos], &data[chunk_size_end], chunk_length, 16);
+                if constexpr(policy_type::strict)
+                {
+                    // The size may only be followed by chunk extensions.
+                    if(ec != std::errc{} || (ptr != &data[chunk_size_end] && *ptr != ';'))
+                    {
+                        return parse_result::chunk_malformed;
+                    }
+                }
+
+                if constexpr(policy_type::max_body_length != no_limit)
+                {
+                    if(chunk_length > policy_type::max_body_length - m_content_length)
+                    {
+                        return parse_result::body_too_large;
+                    }
+                }
+
+                if(chunk_length != 0)
+                {
+                    // Compared before the chunk end is computed so a huge size can not wrap it around.
+                    if(chunk_length > data_length - (chunk_size_end + 1))
+                    {
+                        if constexpr(policy_type::strict)
+                        {
+                            // No data could ever hold the chunk.
+                            if(chunk_length > std::numeric_limits<size_t>::max() - (chunk_size_end + 4))
+                            {
+                                return parse_result::chunk_malformed;
+                            }
+                        }
+                        return parse_result::incomplete;
+                    }
+
+                    // There is a valid chunk with some data, parse over it!
+                    // (note: chunk_size_end includes 1 byte for \r\n already
+                    size_t chunk_end = chunk_size_end + 1 + chunk_length;
+                    if(chunk_end + 2 < data_length)
+                    {
+                        m_pos = chunk_end;
+                        ADVANCE_EXPECT(HTTP_CR, parse_result::chunk_malformed);
+                        ADVANCE_EXPECT(HTTP_LF, parse_result::chunk_malformed);
+                        ADVANCE(); // This chunk parser expects to be on the first byte of the chunk
+
+                        auto result = on_body(chunk_size_end + 2, chunk_length);
+                        if(result != parse_result::advance)
+                        {
+                            return result;
+                        }
+                        m_content_length += chunk_length;
+                    }
+                    else
+                    {
+                        // The chunk has not fully arrived, resume from its size line.
+                        return parse_result::incomplete;
+                    }
+                }
+                else
+                {
+                    // If the chunk length is zero, then ADVANCE_EXPECT the final \r\n and record the body.
+                    if(chunk_size_end + 3 < data_length) // need \n\r\n
+                    {
+                        m_pos = chunk_size_end + 1; // strip the \n trailing chunk_size_end
+                        ADVANCE_EXPECT(HTTP_CR, parse_result::chunk_malformed);
+                        ADVANCE_EXPECT(HTTP_LF, parse_result::chunk_malformed);
+                        ADVANCE();
+                        m_parse_state = parse_state::parsed_body;
+                        break; // while(true)
+                    }
+                    else
+                    {
+                        // its possible to infer the last two bytes *should* be CR LF, but technically
+                        // it is incomplete without them
+                        return parse_result::incomplete;
+                    }
+                }
+            }
+        }
+            break;
+        case body_type::content_length:
+        {
+            if constexpr(policy_type::max_body_length != no_limit)
+            {
+                if(m_content_length > policy_type::max_body_length)
+                {
+                    return parse_result::body_too_large;
+                }
+            }
+
+            // Compared with the data left so a huge Content-Length can not wrap around.
+            if(m_content_length <= data_length - m_pos)
+            {
+                auto offset = m_pos;
+                m_pos += m_content_length;
+                m_parse_state = parse_state::parsed_body;
+
+                auto result = on_body(offset, m_content_length);
+                if(result != parse_result::advance)
+                {
+                    return result;
+                }
+            }
+            else
+            {
+                return parse_result::incomplete;
+            }
+        }
+            break;
+        case body_type::no_body:
+            // nothing to do
+            break;
+    }
+
+    return parse_result::complete;
+}
+
+/**
+ * Rebuilds the header and body views of a parser that was reset and given a detached state, see
+ * request::attach().  The header lines before 'm_pos' were already validated when the state was
+ * detached so they are only split again, the body framing they describe is part of the state.
+ * @param headers_started Has the parser started on the headers, false if they are set otherwise?
+ */
+template<typename parse_state, typename parse_result, typename char_type, typename header_array>
+static auto attach_views_common(
+    std::span<char_type> data,
+    std::size_t m_pos,
+    std::size_t m_headers_start,
+    bool headers_started,
+    parse_state m_parse_state,
+    body_type m_body_type,
+    std::size_t m_content_length,
+    std::size_t m_body_start,
+    header_array& m_headers,
+    std::size_t& m_header_count,
+    std::optional<std::string_view>& m_body,
+    std::string_view& m_chunked_body
+) -> void
+{
+    if(headers_started)
+    {
+        std::size_t pos = m_headers_start;
+        body_type ignored_body_type{body_type::no_body};
+        std::size_t ignored_content_length{0};
+        parse_state ignored_parse_state{m_parse_state};
+        // Already validated, the lenient split of a valid header is the same.
+        parse_headers_common<lenient_policy, parse_state, parse_result>(
+            std::span<const char>{data.data(), m_pos},
+            pos,
+            m_headers_start,
+            false,
+            ignored_body_type,
+            ignored_content_length,
+            ignored_parse_state,
+            [&](std::string_view name, std::string_view value) -> parse_result
+            {
+                if(m_header_count == m_headers.size())
+                {
+                    return parse_result::maximum_headers_exceeded;
+                }
+                m_headers[m_header_count] = {name, value};
+                ++m_header_count;
+                return parse_result::advance;
+            }
+        );
+    }
+
+    if(m_body_type == body_type::chunked && m_body_start != 0)
+    {
+        if constexpr(std::is_const_v<char_type>)
+        {
+            // The raw chunks end at the last chunk's \r\n, not including the terminating zero chunk.
+            std::size_t raw_end = m_pos;
+            if(m_parse_state == parse_state::parsed_body)
+            {
+                std::string_view raw{&data[m_body_start], m_pos - 4 - m_body_start};
+                auto last_line = raw.rfind("\r\n");
+                raw_end = (last_line == std::string_view::npos) ? m_body_start : m_body_start + last_line + 2;
+            }
+            m_chunked_body = std::string_view{&data[m_body_start], raw_end - m_body_start};
+        }
+        else
+        {
+            m_body.emplace(&data[m_body_start], m_content_length);
+        }
+    }
+    else if(m_body_type == body_type::content_length && m_parse_state == parse_state::parsed_body)
+    {
+        m_body.emplace(&data[m_pos - m_content_length], m_content_length);
+    }
+}
+
+/**
+ * Writes the fields shared by the request_state and response_state, the header entries and the
+ * hash into a checkpoint blob that is at least large enough, see checkpoint.hpp.  The header
+ * offsets are relative to the first header's name which starts at 'headers_start'.
+ */
+template<typename state_type, typename header_array>
+static auto checkpoint_common(
+    std::span<std::byte> blob,
+    std::uint8_t kind,
+    const state_type& state,
+    const header_array& m_headers,
+    std::size_t m_header_count
+) -> std::size_t
+{
+    namespace layout = checkpoint_layout;
+
+    for(std::size_t i = 0; i < layout::magic_bytes.size(); ++i)
+    {
+        blob[layout::magic + i] = layout::magic_bytes[i];
+    }
+    layout::store(blob, layout::format, checkpoint_format_version);
+    layout::store(blob, layout::kind, kind);
+    layout::store(blob, layout::parse_state, state.parse_state);
+    layout::store(blob, layout::version, state.version);
+    layout::store(blob, layout::body_type, state.body_type);
+    layout::store(blob, layout::pos, state.pos);
+    layout::store(blob, layout::headers_start, state.headers_start);
+    layout::store(blob, layout::body_start, state.body_start);
+    layout::store(blob, layout::content_length, state.content_length);
+    layout::store(blob, layout::header_count, static_cast<std::uint16_t>(m_header_count));
+
+    std::uint16_t flags{0};
+    for(std::size_t i = 0; i < m_header_count; ++i)
+    {
+        auto& [name, value] = m_headers[i];
+        std::size_t name_start = static_cast<std::size_t>(name.data() - m_headers[0].first.data()) + state.headers_start;
+        std::size_t value_offset = value.empty() ? 0 : static_cast<std::size_t>(value.data() - name.data());
+        if(name.length() > 0xFFFF || value_offset > 0xFFFF || value.length() > 0xFFFFFFFF)
+        {
+            // Too large for an entry, restore() splits the header lines again.
+            flags |= layout::flag_split_headers;
+            break;
+        }
+
+        auto entry = blob.subspan(layout::headers + i * layout::entry_size);
+        layout::store(entry, layout::name_start, static_cast<std::uint32_t>(name_start));
+        layout::store(entry, layout::name_length, static_cast<std::uint16_t>(name.length()));
+        layout::store(entry, layout::value_offset, static_cast<std::uint16_t>(value_offset));
+        layout::store(entry, layout::value_length, static_cast<std::uint32_t>(value.length()));
+    }
+    layout::store(blob, layout::flags, flags);
+
+    std::size_t size = layout::size;
+    if((flags & layout::flag_split_headers) == 0)
+    {
+        size += m_header_count * layout::entry_size;
+    }
+    blob = blob.first(size);
+    layout::store(blob, layout::hash, layout::blob_hash(blob));
+    return size;
+}
+
+/**
+ * Checks the blob is an uncorrupted checkpoint of 'kind' in the current format and loads and
+ * checks the fields shared by the request_state and response_state against the data.
+ * @param header_count Set to the checkpointed number of headers.
+ * @param split_headers Set to true if the header lines have to be split again.
+ */
+template<typename parse_state, typename state_type>
+static auto restore_common(
+    std::span<const std::byte> blob,
+    std::uint8_t kind,
+    std::size_t data_size,
+    state_type& state,
+    std::size_t& header_count,
+    bool& split_headers
+) -> bool
+{
+    namespace layout = checkpoint_layout;
+
+    if(blob.size() < layout::size)
+    {
+        return false;
+    }
+    for(std::size_t i = 0; i < layout::magic_bytes.size(); ++i)
+    {
+        if(blob[layout::magic + i] != layout::magic_bytes[i])
+        {
+            return false;
+        }
+    }
+    if(    layout::load<std::uint8_t>(blob, layout::format) != checkpoint_format_version
+        || layout::load<std::uint8_t>(blob, layout::kind) != kind)
+    {
+        return false;
+    }
+
+    header_count = layout::load<std::uint16_t>(blob, layout::header_count);
+    split_headers = (layout::load<std::uint16_t>(blob, layout::flags) & layout::flag_split_headers) != 0;
+    std::size_t size = layout::size + (split_headers ? 0 : header_count * layout::entry_size);
+    if(blob.size() != size || layout::load<std::uint32_t>(blob, layout::hash) != layout::blob_hash(blob))
+    {
+        return false;
+    }
+
+    state.parse_state = layout::load<std::uint8_t>(blob, layout::parse_state);
+    state.version = layout::load<std::uint8_t>(blob, layout::version);
+    state.body_type = layout::load<std::uint8_t>(blob, layout::body_type);
+    state.pos = layout::load<std::uint32_t>(blob, layout::pos);
+    state.headers_start = layout::load<std::uint32_t>(blob, layout::headers_start);
+    state.body_start = layout::load<std::uint32_t>(blob, layout::body_start);
+    state.content_length = layout::load<std::uint64_t>(blob, layout::content_length);
+
+    std::size_t pos = state.pos;
+    std::size_t body_start = state.body_start;
+    bool parsed_body = state.parse_state == static_cast<std::uint8_t>(parse_state::parsed_body);
+    if(    state.parse_state > static_cast<std::uint8_t>(parse_state::parsed_body)
+        || state.version > static_cast<std::uint8_t>(version::v1_1)
+        || state.body_type > static_cast<std::uint8_t>(body_type::content_length)
+        || pos > data_size
+        || state.headers_start > pos
+        || body_start > pos)
+    {
+        return false;
+    }
+    if(state.body_type == static_cast<std::uint8_t>(body_type::chunked) && body_start != 0)
+    {
+        // The decoded chunks are never longer than the raw chunks, a parsed body ends with at
+        // least the terminating "0\r\n\r\n".
+        return state.content_length <= pos - body_start && (!parsed_body || pos - body_start >= 5);
+    }
+    if(state.body_type == static_cast<std::uint8_t>(body_type::content_length) && parsed_body)
+    {
+        return state.content_length <= pos;
+    }
+    return true;
+}
+
+/**
+ * Sets the headers from the checkpoint's header entries, every entry must be within the header
+ * lines before 'm_pos'.
+ */
+template<typename char_type, typename header_array>
+static auto restore_headers_common(
+    std::span<const std::byte> blob,
+    std::span<char_type> data,
+    std::size_t m_headers_start,
+    std::size_t m_pos,
+    std::size_t count,
+    header_array& m_headers,
+    std::size_t& m_header_count
+) -> bool
+{
+    namespace layout = checkpoint_layout;
+
+    if(count > m_headers.size())
+    {
+        return false;
+    }
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        auto entry = blob.subspan(layout::headers + i * layout::entry_size);
+        std::size_t name_start = layout::load<std::uint32_t>(entry, layout::name_start);
+        std::size_t name_length = layout::load<std::uint16_t>(entry, layout::name_length);
+        std::size_t value_start = name_start + layout::load<std::uint16_t>(entry, layout::value_offset);
+        std::size_t value_length = layout::load<std::uint32_t>(entry, layout::value_length);
+        if(name_start < m_headers_start || name_start + name_length > m_pos || value_start + value_length > m_pos)
+        {
+            return false;
+        }
+        m_headers[i] = {
+            std::string_view{data.data() + name_start, name_length},
+            std::string_view{data.data() + value_start, value_length}
+        };
+    }
+    m_header_count = count;
+    return true;
+}
+
+/**
+ * Runs the dfa_table over the data from 'm_pos', starting in 'state', for dispatch_engine::dfa.
+ * The request line or status line actions are handed to 'on_line', the header actions are
+ * handled here and each header is handed to 'on_header' to be stored.  'm_pos' is only moved at
+ * the end of a line (or the method and uri) so running out of data resumes from there, the same
+ * as parse_headers_common().  The scan never runs past the policy limits of the current state: the
+ * uri, the header block and the header value each end a window, reaching the end of a window
+ * stops with the limit's error without scanning the rest of the data.
+ * @param target Stops with 'advance' once 'on_line' has moved 'm_parse_state' to the target.
+ * @tparam line_functor [](std::uint8_t action, std::uint8_t state, std::uint8_t previous, std::size_t index) -> parse_result;
+ *                      'index' is the byte that entered 'state'.  Returns 'advance' to continue parsing,
+ *                      any other value stops parsing and is returned to the caller.
+ * @tparam header_functor [](std::string_view name, std::string_view value) -> parse_result;
+ */
+template<typename policy_type, typename parse_state, typename parse_result, typename line_functor, typename header_functor>
+static auto parse_head_dfa_common(
+    std::span<const char> data,
+    std::size_t& m_pos,
+    std::uint8_t state,
+    parse_state target,
+    const std::size_t& m_headers_start,
+    bool has_headers,
+    body_type& m_body_type,
+    std::size_t& m_content_length,
+    parse_state& m_parse_state,
+    line_functor&& on_line,
+    header_functor&& on_header
+) -> parse_result
+{
+    const auto& table = dfa_table<policy_type::strict>;
+    const size_t data_length = data.size();
+    size_t name_end{0};
+    size_t value_start{0};
+
+    // One past the last byte 'current' may scan before a limit is crossed, at most the data length.
+    auto window_end = [&](std::uint8_t current) -> size_t
+    {
+        size_t end = data_length;
+        if constexpr(std::is_same_v<parse_result, request_parse_result> && policy_type::max_uri_length != no_limit)
+        {
+            // The uri starts at 'm_pos' and the HTTP_SP after it may be at the limit.
+            if(current == dfa_state::uri_start || current == dfa_state::uri)
+            {
+                end = std::min(end, m_pos + policy_type::max_uri_length + 1);
+            }
+        }
+        if(current >= dfa_state::line_start && current <= dfa_state::head_cr)
+        {
+            if constexpr(policy_type::max_header_bytes != no_limit)
+            {
+                end = std::min(end, m_headers_start + policy_type::max_header_bytes);
+            }
+            if constexpr(policy_type::max_header_value_length != no_limit)
+            {
+                // The \r\n may follow a value at the limit.
+                if(current >= dfa_state::colon && current <= dfa_state::value_cr)
+                {
+                    end = std::min(end, value_start + policy_type::max_header_value_length + 2);
+                }
+            }
+        }
+        return end;
+    };
+
+    size_t end = window_end(state);
+    for(size_t i = m_pos; ; ++i)
+    {
+        if(i >= end)
+        {
+            if(end == data_length)
+            {
+                break; // for(;;)
+            }
+
+            // A window ended before its line or value did.
+            if constexpr(std::is_same_v<parse_result, request_parse_result>)
+            {
+                if(state == dfa_state::uri_start || state == dfa_state::uri)
+                {
+                    return parse_result::uri_too_long;
+                }
+            }
+            if constexpr(policy_type::max_header_value_length != no_limit)
+            {
+                if(state >= dfa_state::colon && state <= dfa_state::value_cr && end == value_start + policy_type::max_header_value_length + 2)
+                {
+                    return parse_result::header_value_too_long;
+                }
+            }
+            return parse_result::headers_too_large;
+        }
+
+        const std::uint8_t previous = state;
+        state = table.next[state][dfa_class_table[static_cast<unsigned char>(data[i])]];
+        const std::uint8_t action = table.action[state];
+        if(TURBO_LIKELY(action == dfa_action::none))
+        {
+            continue;
+        }
+
+        switch(action)
+        {
+            case dfa_action::colon:
+                name_end = i;
+                value_start = i + 1;
+                end = window_end(state);
+                break;
+            case dfa_action::value_ws:
+                // Left trim.
+                value_start = i + 1;
+                end = window_end(state);
+                break;
+            case dfa_action::header:
+            {
+                // The value ends before the \r.
+                size_t value_end = i - 1;
+                if constexpr(policy_type::max_header_value_length != no_limit)
+                {
+                    if(value_end - value_start > policy_type::max_header_value_length)
+                    {
+                        return parse_result::header_value_too_long;
+                    }
+                }
+                if constexpr(policy_type::max_header_bytes != no_limit)
+                {
+                    if(i + 1 - m_headers_start > policy_type::max_header_bytes)
+                    {
+                        return parse_result::headers_too_large;
+                    }
+                }
+
+                // Right trim, an all whitespace value ends up empty.
+                while(value_end > value_start && is_http_ws(data[value_end - 1]))
+                {
+                    --value_end;
+                }
+
+                std::string_view name{&data[m_pos], name_end - m_pos};
+                std::string_view value{&data[value_start], value_end - value_start};
+                m_pos = i + 1;
+
+                auto result = on_header(name, value);
+                if(result != parse_result::advance)
+                {
+                    return result;
+                }
+
+                if constexpr(policy_type::strict)
+                {
+                    result = detect_body_type_strict<parse_result>(name, value, m_body_type, m_content_length);
+                    if(result != parse_result::advance)
+                    {
+                        return result;
+                    }
+                }
+                else
+                {
+                    detect_body_type_lenient(name, value, m_body_type, m_content_length);
+                }
+
+                has_headers = true;
+                end = window_end(state);
+            }
+                break;
+            case dfa_action::head_end:
+                if constexpr(policy_type::max_header_bytes != no_limit)
+                {
+                    if(i + 1 - m_headers_start > policy_type::max_header_bytes)
+                    {
+                        return parse_result::headers_too_large;
+                    }
+                }
+                m_pos = i + 1;
+                // A message without any headers remains in its previous parse state.
+                if(has_headers)
+                {
+                    m_parse_state = parse_state::parsed_headers;
+                }
+                return parse_result::advance;
+            default:
+            {
+                auto result = on_line(action, state, previous, i);
+                if(result != parse_result::advance)
+                {
+                    return result;
+                }
+                if(target <= m_parse_state)
+                {
+                    return parse_result::advance;
+                }
+                end = window_end(state);
+            }
+                break;
+        }
+    }
+
+    // Out of data, fail now if a limit has already been crossed.
+    if(state >= dfa_state::line_start && state <= dfa_state::head_cr)
+    {
+        if constexpr(policy_type::max_header_value_length != no_limit)
+        {
+            if(state >= dfa_state::colon && state <= dfa_state::value_cr)
+            {
+                // A trailing \r could be the start of the \r\n.
+                size_t value_length = data_length - value_start - ((state == dfa_state::value_cr) ? 1 : 0);
+                if(value_length > policy_type::max_header_value_length)
+                {
+                    return parse_result::header_value_too_long;
+                }
+            }
+        }
+        if constexpr(policy_type::max_header_bytes != no_limit)
+        {
+            if(data_length - m_headers_start > policy_type::max_header_bytes)
+            {
+                return parse_result::headers_too_large;
+            }
+        }
+    }
+    return parse_result::incomplete;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse(std::string& data) -> request_parse_result
+{
+    std::span<char> data_span{data.data(), data.length()};
+    return parse(data_span);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse(std::span<char>& data) -> request_parse_result
+{
+    return parse_until(data, request_parse_state::parsed_body);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse(std::span<const char> data) -> request_parse_result
+{
+    return parse_until(data, request_parse_state::parsed_body);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_until(std::string& data, request_parse_state target) -> request_parse_result
+{
+    std::span<char> data_span{data.data(), data.length()};
+    return parse_until(data_span, target);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_until(std::span<char>& data, request_parse_state target) -> request_parse_result
+{
+    auto result = parse_until_impl(data, target);
+    lowercase_host(data);
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_until(std::span<const char> data, request_parse_state target) -> request_parse_result
+{
+    return parse_until_impl(data, target);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::parse_until_impl(std::span<char_type> data, request_parse_state target) -> request_parse_result
+{
+#if defined(__GNUC__)
+    if constexpr(policy_type::dispatch == dispatch_engine::computed_goto)
+    {
+        return parse_until_goto(data, target);
+    }
+#endif
+
+    if(data.empty())
+    {
+        return request_parse_result::incomplete;
+    }
+
+    if constexpr(policy_type::dispatch == dispatch_engine::dfa)
+    {
+        // The DFA parses the request line and the headers in a single pass.
+        if(m_parse_state < request_parse_state::parsed_headers && m_parse_state < target)
+        {
+            auto result = parse_head_dfa(data, target);
+            if(result != request_parse_result::advance)
+            {
+                return result;
+            }
+        }
+        return parse_until_body(data, target);
+    }
+
+    if(m_parse_state == request_parse_state::start && m_parse_state < target)
+    {
+        auto result = parse_method(data);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    // After parsing the Method move on to parsing the URI.
+    if(m_parse_state == request_parse_state::parsed_method && m_parse_state < target)
+    {
+        auto result = parse_uri(data);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == request_parse_state::parsed_uri && m_parse_state < target)
+    {
+        auto result = parse_version(data);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    if(m_parse_state == request_parse_state::parsed_version && m_parse_state < target)
+    {
+        auto result = parse_headers(data);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    return parse_until_body(data, target);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::parse_until_body(std::span<char_type> data, request_parse_state target) -> request_parse_result
+{
+    /**
+     * Its possible there is a body after the headers, but this parser only supports
+     * it if it can deduce how long the body is by either having a content-length header
+     * or chunked encoding.  End of stream is technically a valid http request but
+     * without access to the socket the parser has no way of knowing if its the end or,
+     * thus we'll just report completion upon finishing parsing of the headers.
+     */
+    if(    m_parse_state == request_parse_state::parsed_headers
+        && m_parse_state < target
+        && m_body_type != body_type::no_body
+    )
+    {
+        auto result = parse_body(data);
+        if(result != request_parse_result::advance)
+        {
+            return result;
+        }
+    }
+
+    // Currently does not support trailing headers.
+
+    // Stopped at the target state with stages left to parse, the caller can resume later.
+    if(    target <= m_parse_state
+        && m_parse_state != request_parse_state::parsed_body
+        && !(m_parse_state == request_parse_state::parsed_headers && m_body_type == body_type::no_body)
+    )
+    {
+        return request_parse_result::advance;
+    }
+
+    return request_parse_result::complete;
+}
+
+#if defined(__GNUC__)
+// Label addresses and computed goto are GNU extensions.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::parse_until_goto(std::span<char_type> data, request_parse_state target) -> request_parse_result
+{
+    // Indexed by request_parse_state.
+    static void* const resume[] = {
+        &&parse_start,
+        &&parse_parsed_method,
+        &&parse_parsed_uri,
+        &&parse_parsed_version,
+        &&parse_parsed_headers,
+        &&parse_parsed_body
+    };
+
+    request_parse_result result{request_parse_result::incomplete};
+
+    if(data.empty())
+    {
+        return request_parse_result::incomplete;
+    }
+
+    goto *resume[static_cast<std::size_t>(m_parse_state)];
+
+parse_start:
+    if(target <= request_parse_state::start)
+    {
+        return request_parse_result::advance;
+    }
+    result = parse_method(data);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+parse_parsed_method:
+    if(target <= request_parse_state::parsed_method)
+    {
+        return request_parse_result::advance;
+    }
+    result = parse_uri(data);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+parse_parsed_uri:
+    if(target <= request_parse_state::parsed_uri)
+    {
+        return request_parse_result::advance;
+    }
+    result = parse_version(data);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+parse_parsed_version:
+    if(target <= request_parse_state::parsed_version)
+    {
+        return request_parse_result::advance;
+    }
+    result = parse_headers(data);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+parse_parsed_headers:
+    // See parse_until_impl(), only a body with a known length is parsed.
+    if(m_body_type == body_type::no_body)
+    {
+        return request_parse_result::complete;
+    }
+    if(target <= request_parse_state::parsed_headers)
+    {
+        return request_parse_result::advance;
+    }
+    result = parse_body(data);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+parse_parsed_body:
+    return request_parse_result::complete;
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_head_dfa(std::span<const char> data, request_parse_state target) -> request_parse_result
+{
+    // The DFA state to resume from, indexed by request_parse_state.
+    static constexpr std::array<std::uint8_t, 4> resume{
+        dfa_state::method,
+        dfa_state::uri_start,
+        dfa_state::request_version,
+        dfa_state::line_start
+    };
+
+    auto result = parse_head_dfa_common<policy_type, request_parse_state, request_parse_result>(
+        data,
+        m_pos,
+        resume[static_cast<std::size_t>(m_parse_state)],
+        target,
+        m_headers_start,
+        m_header_count > 0,
+        m_body_type,
+        m_content_length,
+        m_parse_state,
+        [this, &data](std::uint8_t action, std::uint8_t state, std::uint8_t previous, std::size_t i) -> request_parse_result
+        {
+            switch(action)
+            {
+                case dfa_action::method:
+                    m_method = dfa_table<policy_type::strict>.method_of[previous];
+                    m_parse_state = request_parse_state::parsed_method;
+                    m_pos = i + 1;
+                    return request_parse_result::advance;
+                case dfa_action::uri:
+                    m_uri_start_pos = m_pos;
+                    if constexpr(policy_type::max_uri_length != no_limit)
+                    {
+                        if(i - m_uri_start_pos > policy_type::max_uri_length)
+                        {
+                            return request_parse_result::uri_too_long;
+                        }
+                    }
+                    m_uri = std::string_view{&data[m_uri_start_pos], i - m_uri_start_pos};
+                    if(!split_uri_common(m_uri, m_uri_split) && policy_type::strict)
+                    {
+                        return request_parse_result::uri_malformed;
+                    }
+                    m_parse_state = request_parse_state::parsed_uri;
+                    m_pos = i + 1;
+                    if(m_hooks.on_request_line != nullptr)
+                    {
+                        return m_hooks.on_request_line(m_hooks.user_data, m_method, m_uri);
+                    }
+                    return request_parse_result::advance;
+                case dfa_action::version_1_0:
+                    m_version = version::v1_0;
+                    return request_parse_result::advance;
+                case dfa_action::version_1_1:
+                    m_version = version::v1_1;
+                    return request_parse_result::advance;
+                case dfa_action::request_line:
+                    m_parse_state = request_parse_state::parsed_version;
+                    m_pos = i + 1;
+                    m_headers_start = m_pos;
+                    return request_parse_result::advance;
+                default:
+                    break;
+            }
+
+            switch(state)
+            {
+                case dfa_state::error_method:
+                    return request_parse_result::method_unknown;
+                case dfa_state::error_uri:
+                    return request_parse_result::uri_malformed;
+                case dfa_state::error_version_unknown:
+                    return request_parse_result::http_version_unknown;
+                case dfa_state::error_version_malformed:
+                    return request_parse_result::http_version_malformed;
+                default:
+                    return request_parse_result::header_malformed;
+            }
+        },
+        [this](std::string_view name, std::string_view value) -> request_parse_result
+        {
+            return store_header(name, value);
+        }
+    );
+
+    // The uri is the only part of the request line without a fixed length.
+    if constexpr(policy_type::max_uri_length != no_limit)
+    {
+        if(
+                result == request_parse_result::incomplete
+            &&  m_parse_state == request_parse_state::parsed_method
+            &&  data.size() - m_pos > policy_type::max_uri_length
+        )
+        {
+            return request_parse_result::uri_too_long;
+        }
+    }
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_method(std::span<const char> data) -> request_parse_result
+{
+    auto result = parse_method_common(data, m_pos, m_method);
+    if(result == request_parse_result::advance)
+    {
+        m_parse_state = request_parse_state::parsed_method;
+    }
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_uri(std::span<const char> data) -> request_parse_result
+{
+    auto result = parse_uri_common<policy_type>(data, m_pos, m_uri_start_pos, m_uri, &m_uri_split);
+    if(result != request_parse_result::advance)
+    {
+        return result;
+    }
+
+    // If the parser gets this far then its successfully parsed the URI.
+    m_parse_state = request_parse_state::parsed_uri;
+
+    if(m_hooks.on_request_line != nullptr)
+    {
+        return m_hooks.on_request_line(m_hooks.user_data, m_method, m_uri);
+    }
+
+    return request_parse_result::advance;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_version(std::span<const char> data) -> request_parse_result
+{
+    auto result = parse_request_version_common(data, m_pos, m_version);
+    if(result == request_parse_result::advance)
+    {
+        m_parse_state = request_parse_state::parsed_version;
+        m_headers_start = m_pos;
+    }
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::parse_headers(std::span<const char> data) -> request_parse_result
+{
+    auto result = parse_headers_common<policy_type, request_parse_state, request_parse_result>(
+        data,
+        m_pos,
+        m_headers_start,
+        m_header_count > 0,
+        m_body_type,
+        m_content_length,
+        m_parse_state,
+        [this](std::string_view name, std::string_view value) -> request_parse_result
+        {
+            auto index = m_header_count;
+            auto result = store_header(name, value);
+            // Only a stored header has a slot in the layout.
+            if(m_header_count > index)
+            {
+                m_header_layout.record(index, name);
+            }
+            return result;
+        },
+        [this](std::span<const char> limited, std::size_t name_start) -> std::size_t
+        {
+            return m_header_layout.predict(limited, name_start, m_header_count);
+        }
+    );
+    if(result == request_parse_result::advance)
+    {
+        m_header_layout.finish();
+    }
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::store_header(std::string_view name, std::string_view value) -> request_parse_result
+{
+    // We are out of space :(
+    if(m_header_count == header_count)
+    {
+        return request_parse_result::maximum_headers_exceeded;
+    }
+
+    m_headers[m_header_count] = {name, value};
+    ++m_header_count;
+    record_host(name, value);
+
+    if(m_hooks.on_header != nullptr)
+    {
+        return m_hooks.on_header(m_hooks.user_data, name, value);
+    }
+
+    return request_parse_result::advance;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::record_host(std::string_view name, std::string_view value) -> void
+{
+    // Only the first Host header counts, its view is set even if the value is empty.
+    if(m_host.name.data() == nullptr && name.length() == 4 && internal_string_view_iequal(name, "host"))
+    {
+        m_host = split_host(value);
+    }
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::lowercase_host(std::span<char> data) -> void
+{
+    if(!m_host.has_upper)
+    {
+        return;
+    }
+    char* host = data.data() + (m_host.name.data() - data.data());
+    for(std::size_t i = 0; i < m_host.name.length(); ++i)
+    {
+        host[i] = static_cast<char>(tolower_asciitable_add(static_cast<unsigned char>(host[i])));
+    }
+    m_host.has_upper = false;
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::parse_body(std::span<char_type> data) -> request_parse_result
+{
+    if(m_body_type == body_type::chunked && m_body_start == 0)
+    {
+        // First time through record the start of the body, the chunks are decoded in place from here.
+        m_body_start = m_pos;
+        m_content_length = 0; // leverage this for the decoded length
+        if constexpr(std::is_const_v<char_type>)
+        {
+            m_chunked_body = std::string_view{&data[m_pos], 0};
+        }
+        else
+        {
+            m_body.emplace(&data[m_pos], 0);
+        }
+    }
+
+    return parse_body_common<policy_type, request_parse_state, request_parse_result>(
+        data,
+        m_parse_state,
+        m_pos,
+        m_body_type,
+        m_content_length,
+        [this, &data](std::size_t offset, std::size_t length) -> request_parse_result
+        {
+            if(m_body_type == body_type::chunked)
+            {
+                if constexpr(std::is_const_v<char_type>)
+                {
+                    // The data cannot be decoded in place, record the raw chunks through this chunk's \r\n.
+                    m_chunked_body = std::string_view{&data[m_body_start], offset + length + 2 - m_body_start};
+                }
+                else
+                {
+                    // move the data into the correct position. this is major YIKES!
+                    std::memmove(data.data() + (m_body_start + m_content_length), data.data() + offset, length);
+                    // m_content_length is the decoded length before this chunk, parse_body_common adds it.
+                    m_body.emplace(&data[m_body_start], m_content_length + length);
+                }
+            }
+            else
+            {
+                m_body.emplace(&data[offset], length);
+            }
+            return request_parse_result::advance;
+        }
+    );
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::reset() -> void
+{
+    m_parse_state = request_parse_state::start;
+    m_pos = 0;
+    //m_method{method::get};
+    m_uri_start_pos = 0;
+    //m_uri;
+    m_uri_split = uri_split{};
+    m_host = host_split{};
+    //m_version{version::v1_1};
+    m_headers_start = 0;
+    m_header_count = 0;
+    //m_headers;
+    m_body_type = body_type::no_body;
+    m_content_length = 0;
+    m_body_start = 0;
+    m_body = std::nullopt;
+    m_chunked_body = {};
+    m_header_layout.restart();
+    m_arena.release();
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::detach() const -> std::optional<request_state>
+{
+    // Every offset in the state is at most m_pos.
+    if(m_pos > std::numeric_limits<std::uint32_t>::max())
+    {
+        return std::nullopt;
+    }
+
+    request_state state{};
+    state.content_length = m_content_length;
+    state.pos = static_cast<std::uint32_t>(m_pos);
+    state.uri_start = static_cast<std::uint32_t>(m_uri_start_pos);
+    state.uri_length = static_cast<std::uint32_t>(m_uri.length());
+    state.headers_start = static_cast<std::uint32_t>(m_headers_start);
+    state.body_start = static_cast<std::uint32_t>(m_body_start);
+    state.parse_state = static_cast<std::uint8_t>(m_parse_state);
+    state.method = static_cast<std::uint8_t>(m_method);
+    state.version = static_cast<std::uint8_t>(m_version);
+    state.body_type = static_cast<std::uint8_t>(m_body_type);
+    return state;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::attach(const request_state& state, std::string& data) -> void
+{
+    attach_impl(state, std::span<char>{data.data(), data.length()}, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::attach(const request_state& state, std::span<char> data) -> void
+{
+    attach_impl(state, data, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::attach(const request_state& state, std::span<const char> data) -> void
+{
+    attach_impl(state, data, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::attach_impl(const request_state& state, std::span<char_type> data, bool split_headers) -> void
+{
+    reset();
+    m_parse_state = static_cast<request_parse_state>(state.parse_state);
+    m_pos = state.pos;
+    m_method = static_cast<method>(state.method);
+    m_uri_start_pos = state.uri_start;
+    m_version = static_cast<version>(state.version);
+    m_headers_start = state.headers_start;
+    m_body_type = static_cast<body_type>(state.body_type);
+    m_content_length = state.content_length;
+    m_body_start = state.body_start;
+
+    if(m_parse_state >= request_parse_state::parsed_uri)
+    {
+        m_uri = std::string_view{&data[m_uri_start_pos], state.uri_length};
+        split_uri_common(m_uri, m_uri_split);
+    }
+    else if(m_parse_state == request_parse_state::parsed_method && m_uri_start_pos > 0)
+    {
+        // Where the uri splits is not part of the state, scan the partial uri again.
+        m_pos = m_uri_start_pos;
+    }
+
+    attach_views_common<request_parse_state, request_parse_result>(
+        data,
+        m_pos,
+        m_headers_start,
+        split_headers && m_parse_state >= request_parse_state::parsed_version,
+        m_parse_state,
+        m_body_type,
+        m_content_length,
+        m_body_start,
+        m_headers,
+        m_header_count,
+        m_body,
+        m_chunked_body
+    );
+    for(std::size_t i = 0; i < m_header_count; ++i)
+    {
+        record_host(m_headers[i].first, m_headers[i].second);
+        if(m_parse_state == request_parse_state::parsed_version)
+        {
+            m_header_layout.resume(i, m_headers[i].first);
+        }
+    }
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::checkpoint(std::span<std::byte> blob) const -> std::size_t
+{
+    auto detached = detach();
+    if(blob.size() < checkpoint_size() || !detached.has_value())
+    {
+        return 0;
+    }
+
+    auto& state = detached.value();
+    checkpoint_layout::store(blob, checkpoint_layout::method, state.method);
+    checkpoint_layout::store(blob, checkpoint_layout::status_code, std::uint16_t{0});
+    checkpoint_layout::store(blob, checkpoint_layout::uri_start, state.uri_start);
+    checkpoint_layout::store(blob, checkpoint_layout::line_length, state.uri_length);
+    return checkpoint_common(blob, checkpoint_layout::kind_request, state, m_headers, m_header_count);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::restore(std::span<const std::byte> blob, std::string& data) -> bool
+{
+    return restore_impl(blob, std::span<char>{data.data(), data.length()});
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::restore(std::span<const std::byte> blob, std::span<char> data) -> bool
+{
+    return restore_impl(blob, data);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::restore(std::span<const std::byte> blob, std::span<const char> data) -> bool
+{
+    return restore_impl(blob, data);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto request<header_count, policy_type>::restore_impl(std::span<const std::byte> blob, std::span<char_type> data) -> bool
+{
+    reset();
+
+    request_state state{};
+    std::size_t count{0};
+    bool split_headers{false};
+    if(!restore_common<request_parse_state>(blob, checkpoint_layout::kind_request, data.size(), state, count, split_headers))
+    {
+        return false;
+    }
+    state.method = checkpoint_layout::load<std::uint8_t>(blob, checkpoint_layout::method);
+    state.uri_start = checkpoint_layout::load<std::uint32_t>(blob, checkpoint_layout::uri_start);
+    state.uri_length = checkpoint_layout::load<std::uint32_t>(blob, checkpoint_layout::line_length);
+    if(    state.method > static_cast<std::uint8_t>(method::patch)
+        || state.uri_start > state.pos
+        || (state.parse_state >= static_cast<std::uint8_t>(request_parse_state::parsed_uri)
+            && std::size_t{state.uri_start} + state.uri_length > state.pos))
+    {
+        return false;
+    }
+
+    attach_impl(state, data, split_headers);
+    bool restored = split_headers
+        ? m_header_count == count
+        : restore_headers_common(blob, data, m_headers_start, m_pos, count, m_headers, m_header_count);
+    if(!restored)
+    {
+        reset();
+        return false;
+    }
+    for(std::size_t i = 0; !split_headers && i < m_header_count; ++i)
+    {
+        record_host(m_headers[i].first, m_headers[i].second);
+        if(m_parse_state == request_parse_state::parsed_version)
+        {
+            m_header_layout.resume(i, m_headers[i].first);
+        }
+    }
+    return true;
 }
 
-template<std::size_t header_count>
-auto request<header_count>::parse_headers(std::span<char>& data) -> request_parse_result
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::clone_into(std::pmr::memory_resource& arena) const -> request
 {
-    return parse_headers_common<request_parse_state, request_parse_result, header_count>(
-        data,
-        m_pos,
-        m_header_count,
-        m_headers,
-        m_body_type,
-        m_content_length,
-        m_parse_state
-    );
-}
+    request clone{*this};
+    if(m_parse_state < request_parse_state::parsed_uri)
+    {
+        // Nothing points into the data yet.
+        return clone;
+    }
 
-template<std::size_t header_count>
-auto request<header_count>::parse_body(std::span<char>& data) -> request_parse_result
-{
-    return parse_body_common<request_parse_state, request_parse_result>(
-        data,
-        m_parse_state,
-        m_pos,
-        m_body_type,
-        m_body_start,
-        m_content_length,
-        m_body
-    );
-}
+    // The request starts at the beginning of the data, the head ends with the last header.
+    const char* head = m_uri.data() - m_uri_start_pos;
+    const char* head_end = m_uri.data() + m_uri.length();
+    if(m_header_count > 0)
+    {
+        auto& [name, value] = m_headers[m_header_count - 1];
+        head_end = std::max(name.data() + name.length(), value.data() + value.length());
+    }
+    std::string_view body = m_body.has_value() ? m_body.value() : m_chunked_body;
 
-template<std::size_t header_count>
-auto request<header_count>::reset() -> void
-{
-    m_parse_state = request_parse_state::start;
-    m_pos = 0;
-    //m_method{method::get};
-    m_uri_start_pos = 0;
-    //m_uri;
-    //m_version{version::v1_1};
-    m_header_count = 0;
-    //m_headers;
-    m_body_type = body_type::no_body;
-    m_content_length = 0;
-    m_body_start = 0;
-    m_body = std::nullopt;
+    std::size_t head_length = static_cast<std::size_t>(head_end - head);
+    char* copy = static_cast<char*>(arena.allocate(head_length + body.length(), 1));
+    std::memcpy(copy, head, head_length);
+
+    auto rebase = [&](std::string_view view) -> std::string_view
+    {
+        return (view.data() == nullptr) ? view : std::string_view{copy + (view.data() - head), view.length()};
+    };
+    clone.m_uri = rebase(m_uri);
+    clone.m_host.name = rebase(m_host.name);
+    for(std::size_t i = 0; i < m_header_count; ++i)
+    {
+        clone.m_headers[i] = {rebase(m_headers[i].first), rebase(m_headers[i].second)};
+    }
+
+    if(body.data() != nullptr)
+    {
+        std::memcpy(copy + head_length, body.data(), body.length());
+        std::string_view copied_body{copy + head_length, body.length()};
+        if(m_body.has_value())
+        {
+            clone.m_body = copied_body;
+        }
+        else
+        {
+            clone.m_chunked_body = copied_body;
+        }
+    }
+
+    return clone;
 }
 
-template<std::size_t header_count>
-auto request<header_count>::http_header(std::string_view name) const -> std::optional<std::string_view>
+template<std::size_t header_count, typename policy_type>
+auto request<header_count, policy_type>::http_header(std::string_view name) const -> std::optional<std::string_view>
 {
     for(size_t i = 0; i < m_header_count; ++i)
     {
@@ -874,21 +2560,60 @@ auto request<header_count>::http_header(std::string_view name) const -> std::opt
     return std::nullopt;
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse(std::string& data) -> response_parse_result
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse(std::string& data) -> response_parse_result
 {
     std::span<char> data_span{data.data(), data.size()};
     return parse(data_span);
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse(std::span<char>& data) -> response_parse_result
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse(std::span<char>& data) -> response_parse_result
+{
+    return parse_impl(data);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse(std::span<const char> data) -> response_parse_result
+{
+    return parse_impl(data);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto response<header_count, policy_type>::parse_impl(std::span<char_type> data) -> response_parse_result
 {
+#if defined(__GNUC__)
+    if constexpr(policy_type::dispatch == dispatch_engine::computed_goto)
+    {
+        return parse_goto(data);
+    }
+#endif
+
     if(data.empty())
     {
         return response_parse_result::incomplete;
     }
 
+    if constexpr(policy_type::dispatch == dispatch_engine::dfa)
+    {
+        // The DFA parses the status line and the headers in a single pass.
+        if(m_parse_state < response_parse_state::parsed_headers)
+        {
+            auto result = parse_head_dfa(data);
+            if(result != response_parse_result::advance)
+            {
+                return result;
+            }
+        }
+
+        if(m_parse_state == response_parse_state::parsed_headers && m_body_type != body_type::no_body)
+        {
+            return parse_body(data);
+        }
+        return response_parse_result::complete;
+    }
+
     if(m_parse_state == response_parse_state::start)
     {
         auto result = parse_version(data);
@@ -939,130 +2664,274 @@ auto response<header_count>::parse(std::span<char>& data) -> response_parse_resu
     return response_parse_result::complete;
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse_version(std::span<char>& data) -> response_parse_result
+#if defined(__GNUC__)
+// Label addresses and computed goto are GNU extensions.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto response<header_count, policy_type>::parse_goto(std::span<char_type> data) -> response_parse_result
 {
-    auto result = parse_version_common(data, m_pos, m_version);
+    // Indexed by response_parse_state.
+    static void* const resume[] = {
+        &&parse_start,
+        &&parse_parsed_version,
+        &&parse_parsed_status_code,
+        &&parse_parsed_reason_phrase,
+        &&parse_parsed_headers,
+        &&parse_parsed_body
+    };
+
+    response_parse_result result{response_parse_result::incomplete};
 
-    switch(result)
+    if(data.empty())
     {
-
-        case parse_version_result::malformed:
-            return response_parse_result::http_version_malformed;
-        case parse_version_result::unknown:
-            return response_parse_result::http_version_unknown;
-        case parse_version_result::incomplete:
-            return response_parse_result::incomplete;
-        case parse_version_result::advance:
-        {
-            if(TURBO_UNLIKELY(m_pos + 1 >= data.size()))
-            {
-                return response_parse_result::incomplete;
-            }
-            else
-            {
-                ADVANCE_EXPECT(HTTP_SP, response_parse_result::http_version_malformed);
-                ADVANCE();
-                m_parse_state = response_parse_state::parsed_version;
-                return response_parse_result::advance;
-            }
-        }
+        return response_parse_result::incomplete;
     }
 
-    // impossible gcc error
-    return response_parse_result::http_version_unknown;
-}
+    goto *resume[static_cast<std::size_t>(m_parse_state)];
 
-template<std::size_t header_count>
-auto response<header_count>::parse_status_code(std::span<char>& data) -> response_parse_result
-{
-    size_t data_length = data.size();
-    size_t required_bytes = m_pos + 3;
+parse_start:
+    result = parse_version(data);
+    if(result != response_parse_result::advance)
+    {
+        return result;
+    }
 
-    /**
-     * All status codes are 3 digits in length, plus the trailing HTTP_SP, "XXX "
-     */
-    if(TURBO_UNLIKELY(required_bytes > data_length))
+parse_parsed_version:
+    result = parse_status_code(data);
+    if(result != response_parse_result::advance)
     {
-        return response_parse_result::incomplete;
+        return result;
     }
 
-    if(    !std::isdigit(data[m_pos])
-        || !std::isdigit(data[m_pos + 1])
-        || !std::isdigit(data[m_pos + 2])
-    )
+parse_parsed_status_code:
+    result = parse_reason_phrase(data);
+    if(result != response_parse_result::advance)
     {
-        return response_parse_result::http_status_code_malformed;
+        return result;
     }
 
-    std::from_chars(&data[m_pos], &data[required_bytes], m_status_code, 10);
-    if(TURBO_LIKELY(m_status_code != 0))
+parse_parsed_reason_phrase:
+    result = parse_headers(data);
+    if(result != response_parse_result::advance)
     {
-        m_pos += 3; // Advanced 3x past the status code.
-        EXPECT(HTTP_SP, response_parse_result::http_status_code_malformed);
-        ADVANCE();
-        m_parse_state = response_parse_state::parsed_status_code;
-        return response_parse_result::advance;
+        return result;
     }
-    else
+
+parse_parsed_headers:
+    if(m_body_type == body_type::no_body)
     {
-        return response_parse_result::http_status_code_malformed;
+        return response_parse_result::complete;
+    }
+    result = parse_body(data);
+    if(result != response_parse_result::advance)
+    {
+        return result;
     }
+
+parse_parsed_body:
+    return response_parse_result::complete;
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse_reason_phrase(std::span<char>& data) -> response_parse_result
+#pragma GCC diagnostic pop
+#endif
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse_head_dfa(std::span<const char> data) -> response_parse_result
 {
-    // Since the reason phrases are not truely standardized, the parser just looks
-    // for the \r\n that ends the line and sets the m_reason_phrase to the entire section.
-    // Its possible there are only certain characters allowed in the reason phrase, this is
-    // currently not handled by the parser and just looks for \r\n.
+    // The DFA state to resume from, indexed by response_parse_state.
+    static constexpr std::array<std::uint8_t, 4> resume{
+        dfa_state::response_version,
+        dfa_state::status_code,
+        dfa_state::reason_start,
+        dfa_state::line_start
+    };
+
+    return parse_head_dfa_common<policy_type, response_parse_state, response_parse_result>(
+        data,
+        m_pos,
+        resume[static_cast<std::size_t>(m_parse_state)],
+        response_parse_state::parsed_body,
+        m_headers_start,
+        m_header_count > 0,
+        m_body_type,
+        m_content_length,
+        m_parse_state,
+        [this, &data](std::uint8_t action, std::uint8_t state, std::uint8_t, std::size_t i) -> response_parse_result
+        {
+            switch(action)
+            {
+                case dfa_action::version_1_0:
+                    m_version = version::v1_0;
+                    return response_parse_result::advance;
+                case dfa_action::version_1_1:
+                    m_version = version::v1_1;
+                    return response_parse_result::advance;
+                case dfa_action::response_version:
+                    m_parse_state = response_parse_state::parsed_version;
+                    m_pos = i + 1;
+                    return response_parse_result::advance;
+                case dfa_action::status_code:
+                    // The DFA only allows 3 digits.
+                    std::from_chars(&data[i - 3], &data[i], m_status_code, 10);
+                    if(m_status_code == 0)
+                    {
+                        return response_parse_result::http_status_code_malformed;
+                    }
+                    m_parse_state = response_parse_state::parsed_status_code;
+                    m_pos = i + 1;
+                    return response_parse_result::advance;
+                case dfa_action::status_line:
+                    m_reason_phrase = std::string_view{&data[m_pos], i - 1 - m_pos};
+                    m_parse_state = response_parse_state::parsed_reason_phrase;
+                    m_pos = i + 1;
+                    m_headers_start = m_pos;
+                    return response_parse_result::advance;
+                default:
+                    break;
+            }
 
-    size_t value_end = m_pos;
-    if(TURBO_LIKELY(find_crlf(std::string_view{data.data(), data.size()}, value_end)))
+            switch(state)
+            {
+                case dfa_state::error_version_unknown:
+                    return response_parse_result::http_version_unknown;
+                case dfa_state::error_version_malformed:
+                    return response_parse_result::http_version_malformed;
+                case dfa_state::error_status_code:
+                    return response_parse_result::http_status_code_malformed;
+                default:
+                    return response_parse_result::header_malformed;
+            }
+        },
+        [this](std::string_view name, std::string_view value) -> response_parse_result
+        {
+            return store_header(name, value);
+        }
+    );
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse_version(std::span<const char> data) -> response_parse_result
+{
+    auto result = parse_response_version_common(data, m_pos, m_version);
+    if(result == response_parse_result::advance)
     {
-        // If found, value_end will be the byte before \r\n, so calculate the length + 1 for the string view.
-        m_reason_phrase = std::string_view{&data[m_pos], value_end - m_pos + 1};
-        m_pos = value_end + 3; // advance past the \r\n as well
-        m_parse_state = response_parse_state::parsed_reason_phrase;
-        return response_parse_result::advance;
+        m_parse_state = response_parse_state::parsed_version;
     }
-    else
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse_status_code(std::span<const char> data) -> response_parse_result
+{
+    auto result = parse_status_code_common(data, m_pos, m_status_code);
+    if(result == response_parse_result::advance)
     {
-        return response_parse_result::incomplete;
+        m_parse_state = response_parse_state::parsed_status_code;
+    }
+    return result;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse_reason_phrase(std::span<const char> data) -> response_parse_result
+{
+    auto result = parse_reason_phrase_common(data, m_pos, m_reason_phrase);
+    if(result == response_parse_result::advance)
+    {
+        m_parse_state = response_parse_state::parsed_reason_phrase;
+        m_headers_start = m_pos;
     }
+    return result;
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse_headers(std::span<char>& data) -> response_parse_result
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::parse_headers(std::span<const char> data) -> response_parse_result
 {
-    return parse_headers_common<response_parse_state, response_parse_result, header_count>(
+    return parse_headers_common<policy_type, response_parse_state, response_parse_result>(
         data,
         m_pos,
-        m_header_count,
-        m_headers,
+        m_headers_start,
+        m_header_count > 0,
         m_body_type,
         m_content_length,
-        m_parse_state
+        m_parse_state,
+        [this](std::string_view name, std::string_view value) -> response_parse_result
+        {
+            return store_header(name, value);
+        }
     );
 }
 
-template<std::size_t header_count>
-auto response<header_count>::parse_body(std::span<char>& data) -> response_parse_result
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::store_header(std::string_view name, std::string_view value) -> response_parse_result
+{
+    // We are out of space :(
+    if(m_header_count == header_count)
+    {
+        return response_parse_result::maximum_headers_exceeded;
+    }
+
+    m_headers[m_header_count] = {name, value};
+    ++m_header_count;
+
+    return response_parse_result::advance;
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto response<header_count, policy_type>::parse_body(std::span<char_type> data) -> response_parse_result
 {
-    return parse_body_common<response_parse_state, response_parse_result>(
+    if(m_body_type == body_type::chunked && m_body_start == 0)
+    {
+        // First time through record the start of the body, the chunks are decoded in place from here.
+        m_body_start = m_pos;
+        m_content_length = 0; // leverage this for the decoded length
+        if constexpr(std::is_const_v<char_type>)
+        {
+            m_chunked_body = std::string_view{&data[m_pos], 0};
+        }
+        else
+        {
+            m_body.emplace(&data[m_pos], 0);
+        }
+    }
+
+    return parse_body_common<policy_type, response_parse_state, response_parse_result>(
         data,
         m_parse_state,
         m_pos,
         m_body_type,
-        m_body_start,
         m_content_length,
-        m_body
+        [this, &data](std::size_t offset, std::size_t length) -> response_parse_result
+        {
+            if(m_body_type == body_type::chunked)
+            {
+                if constexpr(std::is_const_v<char_type>)
+                {
+                    // The data cannot be decoded in place, record the raw chunks through this chunk's \r\n.
+                    m_chunked_body = std::string_view{&data[m_body_start], offset + length + 2 - m_body_start};
+                }
+                else
+                {
+                    // move the data into the correct position. this is major YIKES!
+                    std::memmove(data.data() + (m_body_start + m_content_length), data.data() + offset, length);
+                    // m_content_length is the decoded length before this chunk, parse_body_common adds it.
+                    m_body.emplace(&data[m_body_start], m_content_length + length);
+                }
+            }
+            else
+            {
+                m_body.emplace(&data[offset], length);
+            }
+            return response_parse_result::advance;
+        }
     );
 }
 
-template<std::size_t header_count>
-auto response<header_count>::reset() -> void
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::reset() -> void
 {
     m_parse_state = response_parse_state::start;
     m_pos = 0;
@@ -1071,6 +2940,7 @@ auto response<header_count>::reset() -> void
     m_status_code = 0;
     //m_reason_phrase;
 
+    m_headers_start = 0;
     m_header_count = 0;
     //m_headers;
 
@@ -1078,10 +2948,154 @@ auto response<header_count>::reset() -> void
     m_content_length = 0;
     m_body_start = 0;
     m_body = std::nullopt;
+    m_chunked_body = {};
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::detach() const -> std::optional<response_state>
+{
+    // Every offset in the state is at most m_pos.
+    if(m_pos > std::numeric_limits<std::uint32_t>::max())
+    {
+        return std::nullopt;
+    }
+
+    response_state state{};
+    state.content_length = m_content_length;
+    state.pos = static_cast<std::uint32_t>(m_pos);
+    state.reason_length = static_cast<std::uint32_t>(m_reason_phrase.length());
+    state.headers_start = static_cast<std::uint32_t>(m_headers_start);
+    state.body_start = static_cast<std::uint32_t>(m_body_start);
+    state.status_code = static_cast<std::uint16_t>(m_status_code);
+    state.parse_state = static_cast<std::uint8_t>(m_parse_state);
+    state.version = static_cast<std::uint8_t>(m_version);
+    state.body_type = static_cast<std::uint8_t>(m_body_type);
+    return state;
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::attach(const response_state& state, std::string& data) -> void
+{
+    attach_impl(state, std::span<char>{data.data(), data.length()}, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::attach(const response_state& state, std::span<char> data) -> void
+{
+    attach_impl(state, data, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::attach(const response_state& state, std::span<const char> data) -> void
+{
+    attach_impl(state, data, true);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto response<header_count, policy_type>::attach_impl(const response_state& state, std::span<char_type> data, bool split_headers) -> void
+{
+    reset();
+    m_parse_state = static_cast<response_parse_state>(state.parse_state);
+    m_pos = state.pos;
+    m_version = static_cast<version>(state.version);
+    m_status_code = state.status_code;
+    m_headers_start = state.headers_start;
+    m_body_type = static_cast<body_type>(state.body_type);
+    m_content_length = state.content_length;
+    m_body_start = state.body_start;
+
+    if(m_parse_state >= response_parse_state::parsed_reason_phrase)
+    {
+        // The reason phrase ends at the \r\n before the headers.
+        m_reason_phrase = std::string_view{&data[m_headers_start - 2 - state.reason_length], state.reason_length};
+    }
+
+    attach_views_common<response_parse_state, response_parse_result>(
+        data,
+        m_pos,
+        m_headers_start,
+        split_headers && m_parse_state >= response_parse_state::parsed_reason_phrase,
+        m_parse_state,
+        m_body_type,
+        m_content_length,
+        m_body_start,
+        m_headers,
+        m_header_count,
+        m_body,
+        m_chunked_body
+    );
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::checkpoint(std::span<std::byte> blob) const -> std::size_t
+{
+    auto detached = detach();
+    if(blob.size() < checkpoint_size() || !detached.has_value())
+    {
+        return 0;
+    }
+
+    auto& state = detached.value();
+    checkpoint_layout::store(blob, checkpoint_layout::method, std::uint8_t{0});
+    checkpoint_layout::store(blob, checkpoint_layout::status_code, state.status_code);
+    checkpoint_layout::store(blob, checkpoint_layout::uri_start, std::uint32_t{0});
+    checkpoint_layout::store(blob, checkpoint_layout::line_length, state.reason_length);
+    return checkpoint_common(blob, checkpoint_layout::kind_response, state, m_headers, m_header_count);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::restore(std::span<const std::byte> blob, std::string& data) -> bool
+{
+    return restore_impl(blob, std::span<char>{data.data(), data.length()});
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::restore(std::span<const std::byte> blob, std::span<char> data) -> bool
+{
+    return restore_impl(blob, data);
+}
+
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::restore(std::span<const std::byte> blob, std::span<const char> data) -> bool
+{
+    return restore_impl(blob, data);
+}
+
+template<std::size_t header_count, typename policy_type>
+template<typename char_type>
+auto response<header_count, policy_type>::restore_impl(std::span<const std::byte> blob, std::span<char_type> data) -> bool
+{
+    reset();
+
+    response_state state{};
+    std::size_t count{0};
+    bool split_headers{false};
+    if(!restore_common<response_parse_state>(blob, checkpoint_layout::kind_response, data.size(), state, count, split_headers))
+    {
+        return false;
+    }
+    state.status_code = checkpoint_layout::load<std::uint16_t>(blob, checkpoint_layout::status_code);
+    state.reason_length = checkpoint_layout::load<std::uint32_t>(blob, checkpoint_layout::line_length);
+    if(    state.parse_state >= static_cast<std::uint8_t>(response_parse_state::parsed_reason_phrase)
+        && std::size_t{state.reason_length} + 2 > state.headers_start)
+    {
+        return false;
+    }
+
+    attach_impl(state, data, split_headers);
+    bool restored = split_headers
+        ? m_header_count == count
+        : restore_headers_common(blob, data, m_headers_start, m_pos, count, m_headers, m_header_count);
+    if(!restored)
+    {
+        reset();
+    }
+    return restored;
 }
 
-template<std::size_t header_count>
-auto response<header_count>::http_header(std::string_view name) const -> std::optional<std::string_view>
+template<std::size_t header_count, typename policy_type>
+auto response<header_count, policy_type>::http_header(std::string_view name) const -> std::optional<std::string_view>
 {
     for(size_t i = 0; i < m_header_count; ++i)
     {
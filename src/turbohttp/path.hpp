@@ -0,0 +1,238 @@
+#pragma once
+
+#include "turbohttp/percent.hpp"
+#include "turbohttp/scan.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace turbo::http
+{
+
+namespace path_detail
+{
+
+/// RFC 3986 unreserved, the characters whose escapes are decoded.
+inline constexpr char_class unreserved_class = make_char_class([](unsigned char c) {
+    return is_ascii_alpha(c) || is_ascii_digit(c) || c == '-' || c == '.' || c == '_' || c == '~';
+});
+
+/**
+ * @return The hex digit 'c' uppercased.
+ */
+constexpr auto upper_hex(char c) -> char
+{
+    return (c >= 'a' && c <= 'f') ? static_cast<char>(c - ('a' - 'A')) : c;
+}
+
+/**
+ * Ends the segment 'out[segment, written)' before a '/' or the end of the path, a "." or ".."
+ * segment is removed and a '/' is written after any other non-empty segment if 'slash'.
+ * @param root The output before 'root' is never removed by a "..".
+ * @return The new written length.
+ */
+inline auto end_segment(char* out, std::size_t root, std::size_t segment, std::size_t written, bool slash) -> std::size_t
+{
+    std::string_view name{out + segment, written - segment};
+    if(name == ".")
+    {
+        return segment;
+    }
+    if(name == "..")
+    {
+        // Remove the previous segment and its '/'.
+        written = segment;
+        if(written > root)
+        {
+            --written;
+            while(written > root && out[written - 1] != '/')
+            {
+                --written;
+            }
+        }
+        return written;
+    }
+    if(slash && !name.empty())
+    {
+        out[written++] = '/';
+    }
+    return written;
+}
+
+} // namespace path_detail
+
+/**
+ * Normalizes 'path' into 'out' so equivalent paths are spelled the same, e.g. for cache keys and
+ * routing (RFC 3986 6.2.2):
+ *  - escapes of unreserved characters are decoded ("%7E" is "~") and the hex digits of every
+ *    other escape are uppercased ("%2f" is "%2F"),
+ *  - runs of '/' are collapsed to one,
+ *  - "." and ".." segments are removed (RFC 3986 5.2.4), a ".." never goes above the root.
+ * Escapes are decoded before the dot segments are removed so "%2E%2E" is a ".." segment.  With
+ * SSE2 16 bytes without a '%' and without a '/' followed by a '/' or '.' are copied at once, and
+ * not at all while nothing has been removed yet, so an already normalized path is only scanned.
+ * The normalized path is never longer than 'path' and each byte is written after it is read, so
+ * 'out' may start at 'path' to normalize in place.
+ * @param path A path without the query, see request::http_path().
+ * @param out At least path.length() bytes.
+ * @return The normalized length, an empty optional if a '%' is not followed by two hex digits.
+ */
+inline auto normalize_path(std::string_view path, char* out) -> std::optional<std::size_t>
+{
+    const char* data = path.data();
+    const std::size_t length = path.length();
+    std::size_t read = 0;
+    std::size_t written = 0;
+
+    // The output before 'root' is never removed by a "..".
+    std::size_t root = 0;
+    if(length > 0 && data[0] == '/')
+    {
+        out[written++] = '/';
+        read = 1;
+        root = 1;
+    }
+    // The start of the current segment in 'out'.
+    std::size_t segment = written;
+
+#if defined(__SSE2__)
+    // The first segment of a relative path has no '/' before it to find a leading '.' with.
+    bool after_slash = root > 0;
+#endif
+    while(read < length)
+    {
+#if defined(__SSE2__)
+        // A "." or ".." decoded one byte at a time so far is finished one byte at a time.
+        const std::string_view partial{out + segment, written - segment};
+        if(after_slash && length - read >= 16 && partial != "." && partial != "..")
+        {
+            // A '%' or a '/' or '.' right after a '/', each byte is compared with the byte before it.
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + read));
+            const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + read - 1));
+            const __m128i slashes = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/'));
+            const __m128i special = _mm_or_si128(
+                _mm_cmpeq_epi8(bytes, _mm_set1_epi8('%')),
+                _mm_and_si128(
+                    _mm_cmpeq_epi8(previous, _mm_set1_epi8('/')),
+                    _mm_or_si128(slashes, _mm_cmpeq_epi8(bytes, _mm_set1_epi8('.')))
+                )
+            );
+            const auto special_mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+            const auto slash_mask = static_cast<unsigned int>(_mm_movemask_epi8(slashes));
+            if(special_mask == 0)
+            {
+                // Branching here rather than advancing by the count below keeps the next load
+                // from waiting on this block.
+                if(out + written != data + read)
+                {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), bytes);
+                }
+                if(slash_mask != 0)
+                {
+                    segment = written + static_cast<std::size_t>(32 - __builtin_clz(slash_mask));
+                }
+                read += 16;
+                written += 16;
+                continue;
+            }
+
+            // The bytes before the first special byte are copied as they are.
+            const auto plain = static_cast<std::size_t>(__builtin_ctz(special_mask | 0x10000));
+            if(written + 16 <= read + plain)
+            {
+                // The store stays clear of the bytes still to be read.
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + written), bytes);
+            }
+            else if(out + written != data + read)
+            {
+                std::memmove(out + written, data + read, plain);
+            }
+            // None of the segments ended by these bytes are empty or dot segments.
+            const unsigned int plain_slashes = slash_mask & ((1u << plain) - 1);
+            if(plain_slashes != 0)
+            {
+                segment = written + static_cast<std::size_t>(32 - __builtin_clz(plain_slashes));
+            }
+            read += plain;
+            written += plain;
+        }
+#endif
+
+        const char c = data[read];
+        if(c == '/')
+        {
+            written = path_detail::end_segment(out, root, segment, written, true);
+            segment = written;
+            ++read;
+#if defined(__SSE2__)
+            after_slash = true;
+#endif
+        }
+        else if(c == '%')
+        {
+            char decoded;
+            if(!percent_detail::decode_escape(path, read, &decoded))
+            {
+                return std::nullopt;
+            }
+            if(path_detail::unreserved_class.contains(decoded))
+            {
+                out[written++] = decoded;
+            }
+            else
+            {
+                const char high = path_detail::upper_hex(data[read + 1]);
+                const char low = path_detail::upper_hex(data[read + 2]);
+                out[written++] = '%';
+                out[written++] = high;
+                out[written++] = low;
+            }
+            read += 3;
+        }
+        else
+        {
+            out[written++] = c;
+            ++read;
+        }
+    }
+    written = path_detail::end_segment(out, root, segment, written, false);
+
+    return written;
+}
+
+/**
+ * Normalizes 'path' in place, see normalize_path(), writing over the start of it in 'data'.
+ * 'path' must be a view into 'data', e.g. request::http_path() of a request parsed from mutable
+ * data with parse(std::string&) or parse(std::span<char>&).
+ * @param data The mutable data 'path' points into.
+ * @param path The path to normalize.
+ * @return A view of the normalized path in 'data', an empty optional if 'path' is not within
+ *         'data' or has a malformed escape, the data may have been partly normalized.
+ */
+inline auto normalize_path_in_place(std::span<char> data, std::string_view path) -> std::optional<std::string_view>
+{
+    if(path.empty())
+    {
+        return path;
+    }
+
+    std::less_equal<const char*> before{};
+    if(!before(data.data(), path.data()) || !before(path.data() + path.length(), data.data() + data.size()))
+    {
+        return std::nullopt;
+    }
+
+    char* out = data.data() + (path.data() - data.data());
+    auto length = normalize_path(path, out);
+    if(!length.has_value())
+    {
+        return std::nullopt;
+    }
+    return std::string_view{out, length.value()};
+}
+
+} // namespace turbo::http
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "turbohttp/arena.hpp"
+#include "turbohttp/scan.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace turbo::http
+{
+
+/**
+ * How '+' is decoded, it only means a space in application/x-www-form-urlencoded data such as
+ * the query string.
+ */
+enum class plus_decoding
+{
+    /// '+' is kept, e.g. for a path.
+    keep,
+    /// '+' is decoded to a space, e.g. for query keys and values.
+    space
+};
+
+namespace percent_detail
+{
+
+/// The value of each hex digit, 0xFF for every other byte.
+inline constexpr std::array<std::uint8_t, 256> hex_values = []() {
+    std::array<std::uint8_t, 256> values{};
+    values.fill(0xFF);
+    for(unsigned int c = 0; c < 10; ++c)
+    {
+        values['0' + c] = static_cast<std::uint8_t>(c);
+    }
+    for(unsigned int c = 0; c < 6; ++c)
+    {
+        values['a' + c] = static_cast<std::uint8_t>(10 + c);
+        values['A' + c] = static_cast<std::uint8_t>(10 + c);
+    }
+    return values;
+}();
+
+/**
+ * Decodes the escape at 'encoded[read]' into 'out'.
+ * @return False if the '%' is not followed by two hex digits.
+ */
+inline auto decode_escape(std::string_view encoded, std::size_t read, char* out) -> bool
+{
+    if(read + 2 >= encoded.length())
+    {
+        return false;
+    }
+    std::uint8_t high = hex_values[static_cast<unsigned char>(encoded[read + 1])];
+    std::uint8_t low = hex_values[static_cast<unsigned char>(encoded[read + 2])];
+    if(high > 0x0F || low > 0x0F)
+    {
+        return false;
+    }
+    *out = static_cast<char>((high << 4) | low);
+    return true;
+}
+
+/**
+ * Decodes one byte or escape at 'encoded[read]' into 'out[written]', advancing both.
+ * @return False if it is a malformed escape.
+ */
+inline auto decode_step(std::string_view encoded, std::size_t& read, char* out, std::size_t& written, plus_decoding plus) -> bool
+{
+    char c = encoded[read];
+    if(c == '%')
+    {
+        if(!decode_escape(encoded, read, out + written))
+        {
+            return false;
+        }
+        ++written;
+        read += 3;
+        return true;
+    }
+    out[written++] = (c == '+' && plus == plus_decoding::space) ? ' ' : c;
+    ++read;
+    return true;
+}
+
+/**
+ * percent_decode() one byte at a time, kept as the reference the vectorized decode is tested
+ * and benchmarked against.
+ */
+inline auto decode_scalar(std::string_view encoded, char* out, plus_decoding plus) -> std::optional<std::size_t>
+{
+    std::size_t read = 0;
+    std::size_t written = 0;
+    while(read < encoded.length())
+    {
+        if(!decode_step(encoded, read, out, written, plus))
+        {
+            return std::nullopt;
+        }
+    }
+    return written;
+}
+
+#if defined(__SSSE3__)
+/// The pshufb indexes that move the bytes of an 8 byte half whose bit is set in the index to the front.
+inline constexpr std::array<std::array<std::uint8_t, 8>, 256> compact_table = []() {
+    std::array<std::array<std::uint8_t, 8>, 256> table{};
+    for(unsigned int keep = 0; keep < 256; ++keep)
+    {
+        std::size_t count = 0;
+        for(unsigned int bit = 0; bit < 8; ++bit)
+        {
+            if(keep & (1u << bit))
+            {
+                table[keep][count++] = static_cast<std::uint8_t>(bit);
+            }
+        }
+        while(count < 8)
+        {
+            table[keep][count++] = 0x80;
+        }
+    }
+    return table;
+}();
+
+/**
+ * Decodes the first 'limit' bytes of the 16 bytes at 'in' and stores the decoded bytes at 'out',
+ * up to 16 bytes are written.  An escape starting before 'limit' that does not end inside the 16
+ * bytes is malformed.
+ * @param limit The number of encoded bytes to decode.  For a full block (16) an escape starting
+ *              in the last two bytes is left for the next block and 'limit' is set to its start.
+ * @return The number of decoded bytes, -1 if an escape is malformed.
+ */
+inline auto decode_block(const char* in, char* out, unsigned int& limit, bool plus_as_space) -> int
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i percent = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('%'));
+    const __m128i plus = plus_as_space ? _mm_cmpeq_epi8(bytes, _mm_set1_epi8('+')) : _mm_setzero_si128();
+    const auto percent_mask = static_cast<unsigned int>(_mm_movemask_epi8(percent));
+    if(limit == 16)
+    {
+        limit = static_cast<unsigned int>(__builtin_ctz((percent_mask & 0xC000) | 0x10000));
+    }
+    if(_mm_movemask_epi8(_mm_or_si128(percent, plus)) == 0)
+    {
+        // Nothing to decode.
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+        return static_cast<int>(limit);
+    }
+
+    // The value of each hex digit, validated against the positions of the '%' below.
+    const __m128i digit = _mm_and_si128(
+        _mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), bytes)
+    );
+    const __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    const __m128i alpha = _mm_and_si128(
+        _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+        _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower)
+    );
+    const __m128i values = _mm_or_si128(
+        _mm_and_si128(digit, _mm_sub_epi8(bytes, _mm_set1_epi8('0'))),
+        _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)))
+    );
+
+    const unsigned int in_limit = (1u << limit) - 1;
+    const auto escapes = percent_mask & in_limit;
+    const auto hex = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+    const unsigned int digits = (escapes << 1) | (escapes << 2);
+    if((digits & ~hex) != 0)
+    {
+        return -1;
+    }
+
+    // The decoded byte at each '%', the first digit shifted into the high nibble.
+    const __m128i decoded = _mm_or_si128(_mm_slli_epi16(_mm_srli_si128(values, 1), 4), _mm_srli_si128(values, 2));
+    __m128i result = _mm_or_si128(_mm_and_si128(percent, decoded), _mm_andnot_si128(percent, bytes));
+    result = _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(' ')), _mm_andnot_si128(plus, result));
+
+    // Drop the two digits of every escape.
+    const unsigned int keep = ~digits & in_limit;
+    const unsigned int keep_low = keep & 0xFF;
+    const unsigned int keep_high = (keep >> 8) & 0xFF;
+    const __m128i shuffle_low = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(compact_table[keep_low].data()));
+    const __m128i shuffle_high = _mm_add_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(compact_table[keep_high].data())),
+        _mm_set1_epi8(8)
+    );
+    const auto low_count = static_cast<unsigned int>(__builtin_popcount(keep_low));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(result, shuffle_low));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + low_count), _mm_shuffle_epi8(result, shuffle_high));
+    return static_cast<int>(low_count + static_cast<unsigned int>(__builtin_popcount(keep_high)));
+}
+#endif
+
+} // namespace percent_detail
+
+/**
+ * Decodes the %XX escapes of 'encoded' into 'out'.  With SSSE3 16 bytes are decoded at a time:
+ * blocks without a '%' (or '+' when decoding it to a space) are copied with a single load and
+ * store, blocks with a few escapes are decoded and validated in the register and their digits
+ * are dropped with two shuffles, blocks with many escapes and the last partial block are decoded
+ * one byte at a time.  Without SSSE3 the runs up to the next '%' found with find_any() are copied
+ * in bulk and the bytes after each '%' are decoded one at a time.  The decoded value is never
+ * longer than the encoded value and each byte is written after it is read, so 'out' may start at
+ * 'encoded' to decode in place.
+ * @param encoded The percent encoded value, e.g. a query value from query_params.
+ * @param out At least encoded.length() bytes.
+ * @param plus How to decode a '+'.
+ * @return The decoded length, an empty optional if a '%' is not followed by two hex digits.
+ */
+inline auto percent_decode(std::string_view encoded, char* out, plus_decoding plus = plus_decoding::keep) -> std::optional<std::size_t>
+{
+    const char* data = encoded.data();
+    const std::size_t length = encoded.length();
+    std::size_t read = 0;
+    std::size_t written = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t block = 16;
+    const bool plus_as_space = plus == plus_decoding::space;
+    while(length - read >= block)
+    {
+        // Blocks with many escapes are decoded one escape at a time, the shuffles and stores of
+        // decode_block() only pay for themselves when most of the block is copied through.
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + read));
+        const auto percent_mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('%'))));
+        if(__builtin_popcount(percent_mask) >= 4)
+        {
+            const std::size_t scalar_end = read + block - 2;
+            while(read < scalar_end)
+            {
+                if(!percent_detail::decode_step(encoded, read, out, written, plus))
+                {
+                    return std::nullopt;
+                }
+            }
+            continue;
+        }
+
+        // Once the escapes have shrunk the data by two the 16 byte store cannot reach the bytes
+        // after the block that are still to be read, until then the decoded bytes are copied out
+        // of a temporary.
+        unsigned int limit = block;
+        std::array<char, block> decoded;
+        const bool direct = written + block <= read + 14;
+        int count = percent_detail::decode_block(data + read, direct ? out + written : decoded.data(), limit, plus_as_space);
+        if(count < 0)
+        {
+            return std::nullopt;
+        }
+        if(!direct)
+        {
+            std::memcpy(out + written, decoded.data(), static_cast<std::size_t>(count));
+        }
+        read += limit;
+        written += static_cast<std::size_t>(count);
+    }
+
+    // The last partial block.
+    while(read < length)
+    {
+        if(!percent_detail::decode_step(encoded, read, out, written, plus))
+        {
+            return std::nullopt;
+        }
+    }
+#else
+    const char other = (plus == plus_decoding::space) ? '+' : '%';
+    while(read < length)
+    {
+        // Copy the run up to the next '%' in bulk, then decode at least 16 bytes one at a time
+        // so values with many escapes do not search for each one.
+        std::size_t found = find_any(data, read, length, '%', other, '%');
+        if(found > read)
+        {
+            if(out + written != data + read)
+            {
+                std::memmove(out + written, data + read, found - read);
+            }
+            written += found - read;
+            read = found;
+        }
+
+        std::size_t scalar_end = std::min(length, read + 16);
+        while(read < scalar_end)
+        {
+            if(!percent_detail::decode_step(encoded, read, out, written, plus))
+            {
+                return std::nullopt;
+            }
+        }
+    }
+#endif
+
+    return written;
+}
+
+/**
+ * Decodes 'value' in place, writing over the start of it in 'data'.  'value' must be a view into
+ * 'data', e.g. a query value of a request parsed from mutable data with parse(std::string&) or
+ * parse(std::span<char>&).
+ * @param data The mutable data 'value' points into.
+ * @param value The percent encoded value.
+ * @param plus How to decode a '+'.
+ * @return A view of the decoded value in 'data', an empty optional if 'value' is not within
+ *         'data' or is malformed, the data may have been partly decoded.
+ */
+inline auto percent_decode_in_place(std::span<char> data, std::string_view value, plus_decoding plus = plus_decoding::keep) -> std::optional<std::string_view>
+{
+    if(value.empty())
+    {
+        return value;
+    }
+
+    std::less_equal<const char*> before{};
+    if(!before(data.data(), value.data()) || !before(value.data() + value.length(), data.data() + data.size()))
+    {
+        return std::nullopt;
+    }
+
+    char* out = data.data() + (value.data() - data.data());
+    auto length = percent_decode(value, out, plus);
+    if(!length.has_value())
+    {
+        return std::nullopt;
+    }
+    return std::string_view{out, length.value()};
+}
+
+/**
+ * Decodes 'value' into the request's arena, see request::arena(), for requests parsed read-only.
+ * Nothing is copied if there is nothing to decode.
+ * @param arena The request's arena.
+ * @param value The percent encoded value.
+ * @param plus How to decode a '+'.
+ * @return The decoded value, an empty optional if 'value' is malformed.
+ */
+template<std::size_t capacity>
+auto percent_decode(request_arena<capacity>& arena, std::string_view value, plus_decoding plus = plus_decoding::keep) -> std::optional<std::string_view>
+{
+    bool escaped = value.find('%') != std::string_view::npos
+        || (plus == plus_decoding::space && value.find('+') != std::string_view::npos);
+    if(!escaped)
+    {
+        return value;
+    }
+
+    auto* out = static_cast<char*>(arena.allocate(value.length(), 1));
+    auto length = percent_decode(value, out, plus);
+    if(!length.has_value())
+    {
+        return std::nullopt;
+    }
+    return std::string_view{out, length.value()};
+}
+
+} // namespace turbo::http
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace turbo::http
+{
+
+/**
+ * Parser policies are compile time options passed as the 'policy_type' template parameter
+ * of the parsers.  A custom policy can derive from one of these and override individual
+ * options, e.g.
+ *
+ *     struct my_policy : public turbo::http::strict_policy
+ *     {
+ *         static constexpr std::size_t max_uri_length{4096};
+ *     };
+ *     turbo::http::request<16, my_policy> parser{};
+ */
+
+/**
+ * How parse() resumes at the saved parse state and moves from one parsing stage to the next.
+ */
+enum class dispatch_engine
+{
+    /// A chain of parse state checks, every stage re-tests the state on the way through.
+    branches,
+    /// A table of label addresses indexed by the parse state, resuming is a single indirect
+    /// jump and each stage falls straight through to the next.  Uses the GNU computed goto
+    /// extension, compilers without it use 'branches'.
+    computed_goto,
+    /// The request line or status line and the headers are parsed one byte at a time by a
+    /// compile time generated state transition table, see dfa.hpp.  The cost per byte is
+    /// constant and the strict_policy validation happens in the same pass.  The body is parsed
+    /// the same as 'branches'.
+    dfa
+};
+
+/// Use as a limit to disable it.
+inline constexpr std::size_t no_limit = std::numeric_limits<std::size_t>::max();
+
+/**
+ * Does the minimum amount of work required to frame the message, intended for trusted traffic.
+ * Header names are anything up to the ':', uri characters are not checked and malformed
+ * Content-Length or chunk size values are ignored.
+ */
+struct lenient_policy
+{
+    /// Validate the message against the RFC 9112 grammar.
+    static constexpr bool strict{false};
+
+    /// The maximum length of the request uri, parsing stops with 'uri_too_long' once it is crossed.
+    static constexpr std::size_t max_uri_length{no_limit};
+    /// The maximum length of the header block including the empty line that ends it,
+    /// parsing stops with 'headers_too_large' once it is crossed.
+    static constexpr std::size_t max_header_bytes{no_limit};
+    /// The maximum length of a single header value before trimming trailing whitespace,
+    /// parsing stops with 'header_value_too_long' once it is crossed.
+    static constexpr std::size_t max_header_value_length{no_limit};
+    /// The maximum length of the Content-Length or decoded chunked body, parsing stops with
+    /// 'body_too_large' as soon as the Content-Length or chunk size crosses it.
+    static constexpr std::size_t max_body_length{no_limit};
+
+    /// How parse() dispatches on the parse state.
+    static constexpr dispatch_engine dispatch{dispatch_engine::branches};
+
+    /// The request parser remembers the header names of the previous request in a buffer of this
+    /// many bytes and checks the next request's names against them with a memcmp before scanning
+    /// for the ':', see header_layout.hpp.  Meant for keep-alive connections from repeat clients,
+    /// 0 disables it.  Only the 'branches' and 'computed_goto' dispatch engines use it.
+    static constexpr std::size_t header_layout_bytes{0};
+
+    /// The alignment of the request and response objects, the default is their natural alignment.
+    /// 64 (a cache line) starts every parser in an array on its own cache line so parsers used by
+    /// different threads never share one.
+    static constexpr std::size_t parser_alignment{alignof(std::size_t)};
+
+    /// The bytes of scratch memory carried inside each request for decoded values, released by
+    /// reset(), see request::arena() and arena.hpp.  0 disables it.
+    static constexpr std::size_t arena_bytes{0};
+};
+
+/**
+ * Validates the message against the RFC 9112 grammar, intended for untrusted traffic.
+ * Header names must be tokens (tchar), header values must be field-vchar/SP/HTAB, uri
+ * characters must be valid RFC 3986 characters, obs-fold header lines are rejected as are
+ * malformed, conflicting or chunked + Content-Length values and malformed chunk sizes.
+ */
+struct strict_policy : public lenient_policy
+{
+    /// Validate the message against the RFC 9112 grammar.
+    static constexpr bool strict{true};
+};
+
+} // namespace turbo::http
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "turbohttp/scan.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace turbo::http
+{
+
+/**
+ * A view of a query string, see request::http_query().  Iterating yields the (key, value) pair of
+ * each '&' separated parameter as views into the query, nothing is copied or decoded, see
+ * percent.hpp to decode them.  A parameter without a '=' has an empty value and empty parameters
+ * ("a=1&&b=2") are skipped.  The '&' and '=' are found 16 or 32 bytes at a time, see find_any().
+ */
+class query_params
+{
+public:
+    class iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::pair<std::string_view, std::string_view>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        iterator() = default;
+        explicit iterator(std::string_view remaining)
+            : m_remaining(remaining)
+        {
+            next();
+        }
+
+        auto operator*() const -> reference { return m_param; }
+        auto operator->() const -> pointer { return &m_param; }
+
+        auto operator++() -> iterator&
+        {
+            next();
+            return *this;
+        }
+
+        auto operator++(int) -> iterator
+        {
+            iterator copy{*this};
+            next();
+            return copy;
+        }
+
+        auto operator==(const iterator& other) const -> bool
+        {
+            return m_param.first.data() == other.m_param.first.data() && m_remaining.data() == other.m_remaining.data();
+        }
+
+        auto operator!=(const iterator& other) const -> bool { return !(*this == other); }
+
+    private:
+        auto next() -> void
+        {
+            const char* data = m_remaining.data();
+            std::size_t length = m_remaining.length();
+            std::size_t pos = 0;
+            while(pos < length && data[pos] == '&')
+            {
+                ++pos;
+            }
+            if(pos == length)
+            {
+                // The end iterator.
+                m_remaining = {};
+                m_param = {};
+                return;
+            }
+
+            std::size_t key_end = find_any(data, pos, length, '=', '&', '&');
+            std::size_t param_end = key_end;
+            std::string_view value{};
+            if(key_end < length && data[key_end] == '=')
+            {
+                auto* found = static_cast<const char*>(std::memchr(data + key_end + 1, '&', length - key_end - 1));
+                param_end = (found == nullptr) ? length : static_cast<std::size_t>(found - data);
+                value = std::string_view{data + key_end + 1, param_end - key_end - 1};
+            }
+
+            m_param = {std::string_view{data + pos, key_end - pos}, value};
+            m_remaining = std::string_view{data + param_end, length - param_end};
+        }
+
+        /// The query after the current parameter.
+        std::string_view m_remaining{};
+        /// The current parameter, default constructed views for the end iterator.
+        value_type m_param{};
+    };
+
+    query_params() = default;
+    explicit query_params(std::string_view query)
+        : m_query(query)
+    {
+
+    }
+
+    auto begin() const -> iterator { return iterator{m_query}; }
+    auto end() const -> iterator { return iterator{}; }
+
+    /**
+     * Finds the first parameter given by key (case sensitive), the key is compared undecoded.
+     * @param key Find this parameter's value.
+     * @return The value if the query has the parameter, otherwise an empty optional.
+     */
+    auto find(std::string_view key) const -> std::optional<std::string_view>
+    {
+        for(const auto& [name, value] : *this)
+        {
+            if(name == key)
+            {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @return The query string without the '?'.
+     */
+    auto raw() const -> std::string_view { return m_query; }
+
+private:
+    /// The query string without the '?'.
+    std::string_view m_query{};
+};
+
+} // namespace turbo::http
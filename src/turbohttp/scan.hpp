@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace turbo::http
+{
+
+/**
+ * A set of ASCII characters used to validate or scan the message, bytes >= 0x80 are never
+ * members.  Besides the 256 entry lookup table the set is stored as two 16 byte nibble tables,
+ * a byte 'c' is a member if (nibble_low[c & 0x0F] & nibble_high[c >> 4]) != 0.  This allows
+ * classifying 16 bytes at a time with two shuffles when SSSE3 is available.
+ */
+struct char_class
+{
+    /// One entry per byte value, true if the byte is a member.
+    std::array<bool, 256> table{};
+    /// Bit 'h' of entry 'l' is set if the byte (h << 4 | l) is a member.
+    std::array<uint8_t, 16> nibble_low{};
+    /// Entry 'h' is (1 << h) for the ASCII high nibbles, otherwise 0.
+    std::array<uint8_t, 16> nibble_high{};
+
+    constexpr auto contains(char c) const -> bool { return table[static_cast<unsigned char>(c)]; }
+};
+
+/**
+ * @tparam Predicate [](unsigned char c) -> bool;
+ * @param predicate Called with every ASCII value, returns true if it is a member.
+ * @return The char_class of the ASCII characters the predicate accepted.
+ */
+template<typename Predicate>
+constexpr auto make_char_class(Predicate predicate) -> char_class
+{
+    char_class cls{};
+    for(unsigned int c = 0; c < 0x80; ++c)
+    {
+        if(predicate(static_cast<unsigned char>(c)))
+        {
+            cls.table[c] = true;
+            cls.nibble_low[c & 0x0F] |= static_cast<uint8_t>(1u << (c >> 4));
+        }
+    }
+    for(unsigned int h = 0; h < 8; ++h)
+    {
+        cls.nibble_high[h] = static_cast<uint8_t>(1u << h);
+    }
+    return cls;
+}
+
+constexpr auto is_ascii_alpha(unsigned char c) -> bool
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+constexpr auto is_ascii_digit(unsigned char c) -> bool
+{
+    return c >= '0' && c <= '9';
+}
+
+/// RFC 9110 tchar, the characters of a token such as a header name.
+inline constexpr char_class tchar_class = make_char_class([](unsigned char c) {
+    switch(c)
+    {
+        case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+':
+        case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+            return true;
+        default:
+            return is_ascii_alpha(c) || is_ascii_digit(c);
+    }
+});
+
+/// The bytes that are not allowed in a header value, CTLs other than HTAB and DEL.
+inline constexpr char_class field_invalid_class = make_char_class([](unsigned char c) {
+    return (c < 0x20 && c != '\t') || c == 0x7F;
+});
+
+/// RFC 3986 unreserved, reserved and '%' characters allowed in a request target.
+inline constexpr char_class uri_class = make_char_class([](unsigned char c) {
+    switch(c)
+    {
+        case '-': case '.': case '_': case '~':                                     // unreserved
+        case ':': case '/': case '?': case '#': case '[': case ']': case '@':       // gen-delims
+        case '!': case '$': case '&': case '\'': case '(': case ')':                // sub-delims
+        case '*': case '+': case ',': case ';': case '=':
+        case '%':                                                                   // pct-encoded
+            return true;
+        default:
+            return is_ascii_alpha(c) || is_ascii_digit(c);
+    }
+});
+
+/// The uri characters other than the '?' and '#' that split it into the path, query and fragment.
+inline constexpr char_class uri_split_class = make_char_class([](unsigned char c) {
+    return uri_class.contains(static_cast<char>(c)) && c != '?' && c != '#';
+});
+
+/// RFC 3986 scheme characters after the first ALPHA.
+inline constexpr char_class scheme_class = make_char_class([](unsigned char c) {
+    return is_ascii_alpha(c) || is_ascii_digit(c) || c == '+' || c == '-' || c == '.';
+});
+
+/// The bytes that split an authority into the userinfo, host and port, and the '/' that ends it.
+inline constexpr char_class authority_delimiter_class = make_char_class([](unsigned char c) {
+    return c == '/' || c == '@' || c == ':' || c == ']';
+});
+
+/**
+ * Finds the first byte in [pos, end) whose membership in 'cls' equals 'member'.
+ * @tparam member True to find the first member, false to find the first non-member.
+ * @param data The data to scan.
+ * @param pos The index to start scanning at.
+ * @param end One past the last index to scan.
+ * @param cls The character class to test each byte against.
+ * @return The index of the byte found, otherwise 'end'.
+ */
+template<bool member>
+inline auto find_first(const char* data, std::size_t pos, std::size_t end, const char_class& cls) -> std::size_t
+{
+#if defined(__SSSE3__)
+    const __m128i low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.nibble_low.data()));
+    const __m128i high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cls.nibble_high.data()));
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+
+    while(pos + 16 <= end)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i low  = _mm_shuffle_epi8(low_table, _mm_and_si128(bytes, nibble_mask));
+        __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble_mask));
+        // Set for every byte that is not a member.
+        uint32_t non_members = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(low, high), zero)));
+        uint32_t found = member ? (~non_members & 0xFFFF) : non_members;
+        if(found != 0)
+        {
+            return pos + static_cast<std::size_t>(__builtin_ctz(found));
+        }
+        pos += 16;
+    }
+#endif
+
+#define FIND_FIRST_CHECK() { if(cls.contains(data[pos]) == member) return pos; ++pos; }
+    // lets check 8 chars in a row!
+    while(pos + 8 <= end)
+    {
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+        FIND_FIRST_CHECK();
+    }
+#undef FIND_FIRST_CHECK
+
+    // go one by one...
+    while(pos < end)
+    {
+        if(cls.contains(data[pos]) == member)
+        {
+            return pos;
+        }
+        ++pos;
+    }
+
+    return end;
+}
+
+/**
+ * Finds the first byte in [pos, end) that is 'a', 'b' or 'c', comparing 32 bytes at a time with
+ * AVX2 or 16 bytes at a time with SSE2.
+ * @return The index of the byte found, otherwise 'end'.
+ */
+inline auto find_any(const char* data, std::size_t pos, std::size_t end, char a, char b, char c) -> std::size_t
+{
+#if defined(__AVX2__)
+    const __m256i wide_a = _mm256_set1_epi8(a);
+    const __m256i wide_b = _mm256_set1_epi8(b);
+    const __m256i wide_c = _mm256_set1_epi8(c);
+
+    while(pos + 32 <= end)
+    {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        __m256i found = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(bytes, wide_a), _mm256_cmpeq_epi8(bytes, wide_b)),
+            _mm256_cmpeq_epi8(bytes, wide_c)
+        );
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+        if(mask != 0)
+        {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        pos += 32;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i match_a = _mm_set1_epi8(a);
+    const __m128i match_b = _mm_set1_epi8(b);
+    const __m128i match_c = _mm_set1_epi8(c);
+
+    while(pos + 16 <= end)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        __m128i found = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, match_a), _mm_cmpeq_epi8(bytes, match_b)),
+            _mm_cmpeq_epi8(bytes, match_c)
+        );
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+        if(mask != 0)
+        {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+        pos += 16;
+    }
+#endif
+
+    while(pos < end)
+    {
+        char current = data[pos];
+        if(current == a || current == b || current == c)
+        {
+            return pos;
+        }
+        ++pos;
+    }
+
+    return end;
+}
+
+} // namespace turbo::http
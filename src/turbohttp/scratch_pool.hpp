@@ -0,0 +1,100 @@
+#pragma once
+
+#include "turbohttp/parser.hpp"
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace turbo::http
+{
+
+/**
+ * A fixed number of full parsers shared by many mostly idle connections, e.g. one pool per
+ * thread.  Each connection only keeps the small detached state (request_state or
+ * response_state), a parser is bound to it with bind() while its data is being parsed and
+ * unbind() detaches the state back into the connection so the parser can be bound to the next one.
+ *
+ *     auto* parser = pool.bind(connection.state, connection.buffer);
+ *     auto result = parser->parse(connection.buffer);
+ *     ...
+ *     pool.unbind(parser, connection.state);
+ *
+ * @tparam parser_type A request or response.
+ * @tparam capacity The number of parsers that can be bound at once.
+ */
+template<typename parser_type, std::size_t capacity>
+class scratch_pool
+{
+public:
+    using state_type = typename decltype(std::declval<const parser_type&>().detach())::value_type;
+
+    scratch_pool()
+    {
+        for(std::size_t i = 0; i < capacity; ++i)
+        {
+            m_free[i] = capacity - 1 - i;
+        }
+    }
+    ~scratch_pool() = default;
+
+    // Bound parsers are handed out by address.
+    scratch_pool(const scratch_pool&) = delete;
+    scratch_pool(scratch_pool&&) = delete;
+    auto operator=(const scratch_pool&) -> scratch_pool& = delete;
+    auto operator=(scratch_pool&&) -> scratch_pool& = delete;
+
+    /**
+     * Binds a free parser to a connection's detached state, see request::attach().
+     * @param state The connection's state.
+     * @param data The connection's data.
+     * @return The bound parser, nullptr if every parser is already bound.
+     */
+    template<typename data_type>
+    auto bind(const state_type& state, data_type&& data) -> parser_type*
+    {
+        if(m_free_count == 0)
+        {
+            return nullptr;
+        }
+
+        auto* parser = &m_parsers[m_free[--m_free_count]];
+        parser->attach(state, std::forward<data_type>(data));
+        return parser;
+    }
+
+    /**
+     * Detaches the parser's state into the connection's state and frees the parser, the views
+     * into the connection's data it holds are no longer valid.
+     * @param parser A parser returned by bind().
+     * @param state The connection's state.
+     * @return False if the state can not be detached, see request::detach(), the parser stays
+     *         bound and the connection's state is unchanged.
+     */
+    auto unbind(parser_type* parser, state_type& state) -> bool
+    {
+        auto detached = parser->detach();
+        if(!detached.has_value())
+        {
+            return false;
+        }
+        state = detached.value();
+        m_free[m_free_count++] = static_cast<std::size_t>(parser - m_parsers.data());
+        return true;
+    }
+
+    /**
+     * @return The number of parsers that are not bound.
+     */
+    auto available() const -> std::size_t { return m_free_count; }
+
+private:
+    /// The parsers.
+    std::array<parser_type, capacity> m_parsers{};
+    /// The indexes of the free parsers, the first 'm_free_count' are valid.
+    std::array<std::size_t, capacity> m_free{};
+    /// The number of free parsers.
+    std::size_t m_free_count{capacity};
+};
+
+} // namespace turbo::http
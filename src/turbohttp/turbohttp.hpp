@@ -1,5 +1,16 @@
 #pragma once
 
 #include "turbohttp/method.hpp"
+#include "turbohttp/policy.hpp"
 #include "turbohttp/version.hpp"
 #include "turbohttp/parser.hpp"
+#include "turbohttp/event_parser.hpp"
+#include "turbohttp/batch.hpp"
+#include "turbohttp/scratch_pool.hpp"
+#include "turbohttp/checkpoint.hpp"
+#include "turbohttp/arena.hpp"
+#include "turbohttp/buffer_pool.hpp"
+#include "turbohttp/connection_parser.hpp"
+#include "turbohttp/percent.hpp"
+#include "turbohttp/path.hpp"
+#include "turbohttp/host.hpp"
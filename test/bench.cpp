@@ -2,10 +2,53 @@
 #include "catch.hpp"
 #include <turbohttp/turbohttp.hpp>
 
-#include <turbohttp/turbohttp.hpp>
+#include <turbohttp/lanes.hpp>
 
 #include <iostream>
+#include <map>
+#include <array>
 #include <chrono>
+#include <cstring>
+#include <memory_resource>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+template<typename request_type>
+static auto bench_request(std::string& buffer, size_t iterations) -> void
+{
+    auto start = std::chrono::steady_clock::now();
+    request_type request{};
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        request.reset();
+        request.parse(buffer);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    auto total = end - start;
+    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(total).count();
+    std::cout << "Total running time in ms: " << total_ms  << "\n";
+
+    double requests_per_second = ((double)iterations) / total_ms * 1000;
+    std::cout << "requests/sec: " << (uint64_t)requests_per_second << "\n";
+    std::cout << "MegaBytes per second: " << (buffer.length() * requests_per_second) / 1024 / 1024 << "\n";
+}
+
+static std::string bench_request_buffer =
+    "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
+    "Host: www.kittyhell.com\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10.6; ja-JP-mac; rv:1.9.2.3) Gecko/20100401 Firefox/3.6.3 Pathtraq/0.9\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
+    "Accept-Encoding: gzip,deflate\r\n"
+    "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
+    "Keep-Alive: 115\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; __utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; __utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+    "\r\n";
 
 TEST_CASE("Benchmark")
 {
@@ -22,36 +65,672 @@ TEST_CASE("Benchmark")
     // "Accept-Language: en-US,en;q=0.8\r\n"
     // "Accept-Charset: ISO-8859-1,utf-8;q=0.7,*;q=0.3\r\n"
     // "Cookie: name=wookie\r\n\r\n";
-    std::string buffer =
-        "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
-        "Host: www.kittyhell.com\r\n"
-        "User-Agent: Mozilla/5.0 (Macintosh; U; Intel Mac OS X 10.6; ja-JP-mac; rv:1.9.2.3) Gecko/20100401 Firefox/3.6.3 Pathtraq/0.9\r\n"
-        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
-        "Accept-Language: ja,en-us;q=0.7,en;q=0.3\r\n"
-        "Accept-Encoding: gzip,deflate\r\n"
-        "Accept-Charset: Shift_JIS,utf-8;q=0.7,*;q=0.7\r\n"
-        "Keep-Alive: 115\r\n"
-        "Connection: keep-alive\r\n"
-        "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=xxxxxxxxxx; __utma=xxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.xxxxxxxxxx.x; __utmz=xxxxxxxxx.xxxxxxxxxx.x.x.utmccn=(referral)|utmcsr=reader.livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
-        "\r\n";
+    std::string buffer = bench_request_buffer;
     constexpr size_t iterations = 10'000'000;
 
+    std::cout << "lenient_policy\n";
+    bench_request<turbo::http::request<>>(buffer, iterations);
+
+    REQUIRE(true);
+}
+
+TEST_CASE("Benchmark strict_policy")
+{
+    // Same request as above so the cost of validating the request is known.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 10'000'000;
+
+    std::cout << "strict_policy\n";
+    bench_request<turbo::http::request<16, turbo::http::strict_policy>>(buffer, iterations);
+
+    REQUIRE(true);
+}
+
+TEST_CASE("Benchmark parse_batch")
+{
+    // Enough buffers and requests that they do not fit in L2, visited in a shuffled order like the
+    // ready connections of an event loop so the hardware prefetcher cannot hide the cache misses.
+    constexpr size_t buffer_count = 16'384;
+    constexpr size_t batch_size = 64;
+    constexpr size_t passes = 20;
+
+    std::vector<std::string> buffers(buffer_count, bench_request_buffer);
+    std::vector<turbo::http::request<>> requests(buffer_count);
+    std::vector<size_t> order(buffer_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937{42});
+
+    auto report = [](const char* name, auto start, auto end)
+    {
+        auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        double requests_per_second = ((double)(buffer_count * passes)) / total_ms * 1000;
+        std::cout << name << " requests/sec: " << (uint64_t)requests_per_second << "\n";
+    };
+
+    size_t completed{0};
+    auto start = std::chrono::steady_clock::now();
+    for(size_t pass = 0; pass < passes; ++pass)
+    {
+        for(size_t i : order)
+        {
+            requests[i].reset();
+            completed += requests[i].parse(buffers[i]) == turbo::http::request_parse_result::complete;
+        }
+    }
+    report("sequential", start, std::chrono::steady_clock::now());
+    REQUIRE(completed == buffer_count * passes);
+
+    completed = 0;
+    std::vector<turbo::http::batch_entry<turbo::http::request<>>> batch(batch_size);
+    start = std::chrono::steady_clock::now();
+    for(size_t pass = 0; pass < passes; ++pass)
+    {
+        for(size_t first = 0; first < buffer_count; first += batch_size)
+        {
+            for(size_t j = 0; j < batch_size; ++j)
+            {
+                size_t i = order[first + j];
+                requests[i].reset();
+                batch[j] = {&requests[i], {buffers[i].data(), buffers[i].length()}};
+            }
+            turbo::http::parse_batch(std::span{batch});
+            for(auto& entry : batch)
+            {
+                completed += entry.result == turbo::http::request_parse_result::complete;
+            }
+        }
+    }
+    report("parse_batch", start, std::chrono::steady_clock::now());
+    REQUIRE(completed == buffer_count * passes);
+}
+
+TEST_CASE("Benchmark parse_lanes")
+{
+    // Small uniform API requests where the fixed cost per request dominates, the lanes only use
+    // SIMD when built with SSSE3 (e.g. -march=native), otherwise both loops are the same.  Kept to
+    // measure the experimental lanes against parse(), which is still about twice as fast here.
+    std::vector<std::string> buffers{
+        "GET /api/v1/users/12345 HTTP/1.1\r\nHost: api.example.com\r\nAccept: application/json\r\n\r\n",
+        "GET /api/v1/orders?page=2 HTTP/1.1\r\nHost: api.example.com\r\nAuthorization: Bearer abcdef0123456789\r\nAccept: */*\r\n\r\n",
+        "POST /api/v1/login HTTP/1.1\r\nHost: api.example.com\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}",
+        "GET /health HTTP/1.1\r\nHost: api.example.com\r\n\r\n",
+        "GET /api/v1/users/67890/profile HTTP/1.1\r\nHost: api.example.com\r\nUser-Agent: rpc-client/1.2\r\nAccept: application/json\r\n\r\n",
+        "DELETE /api/v1/sessions/42 HTTP/1.1\r\nHost: api.example.com\r\nX-Request-Id: 7f3c2a\r\n\r\n",
+        "PUT /api/v1/items/9 HTTP/1.1\r\nHost: api.example.com\r\nContent-Length: 4\r\n\r\ndata",
+        "GET /api/v1/status HTTP/1.1\r\nHost: api.example.com\r\nConnection: keep-alive\r\n\r\n"
+    };
+    constexpr size_t iterations = 250'000;
+
+    std::vector<turbo::http::request<>> requests(buffers.size());
+    std::vector<turbo::http::batch_entry<turbo::http::request<>>> batch{};
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        batch.push_back({&requests[i], {buffers[i].data(), buffers[i].length()}});
+    }
+
+    auto report = [&buffers](const char* name, auto start, auto end)
+    {
+        auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        double requests_per_second = ((double)(buffers.size() * iterations)) / total_ms * 1000;
+        std::cout << name << " requests/sec: " << (uint64_t)requests_per_second << "\n";
+    };
+
+    size_t completed{0};
+    auto start = std::chrono::steady_clock::now();
+    for(size_t n = 0; n < iterations; ++n)
+    {
+        for(size_t i = 0; i < buffers.size(); ++i)
+        {
+            requests[i].reset();
+            completed += requests[i].parse(buffers[i]) == turbo::http::request_parse_result::complete;
+        }
+    }
+    report("sequential", start, std::chrono::steady_clock::now());
+    REQUIRE(completed == buffers.size() * iterations);
+
+    completed = 0;
+    start = std::chrono::steady_clock::now();
+    for(size_t n = 0; n < iterations; ++n)
+    {
+        turbo::http::experimental::parse_lanes(std::span{batch});
+        for(auto& entry : batch)
+        {
+            completed += entry.result == turbo::http::request_parse_result::complete;
+        }
+    }
+    report("parse_lanes", start, std::chrono::steady_clock::now());
+    REQUIRE(completed == buffers.size() * iterations);
+}
+
+template<typename request_type>
+static auto bench_fragmented(const char* name, std::string& buffer, size_t fragment, size_t iterations) -> void
+{
+    request_type request{};
+    size_t completed{0};
     auto start = std::chrono::steady_clock::now();
-    turbo::http::request request{};
     for(size_t i = 0; i < iterations; ++i)
     {
         request.reset();
-        request.parse(buffer);
+        for(size_t length = fragment; ; length += fragment)
+        {
+            std::span<char> data{buffer.data(), std::min(length, buffer.length())};
+            if(request.parse(data) != turbo::http::request_parse_result::incomplete)
+            {
+                ++completed;
+                break;
+            }
+        }
     }
-    auto end = std::chrono::steady_clock::now();
+    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
 
-    auto total = end - start;
-    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(total).count();
-    std::cout << "Total running time in ms: " << total_ms  << "\n";
+    double requests_per_second = ((double)iterations) / total_ms * 1000;
+    std::cout << name << " requests/sec: " << (uint64_t)requests_per_second << "\n";
+    REQUIRE(completed == iterations);
+}
+
+struct bench_goto_policy : public turbo::http::lenient_policy
+{
+    static constexpr turbo::http::dispatch_engine dispatch{turbo::http::dispatch_engine::computed_goto};
+};
+
+TEST_CASE("Benchmark dispatch engines")
+{
+    // The request arrives in small fragments so most parse() calls resume part way through.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t fragment = 16;
+    constexpr size_t iterations = 250'000;
+
+    bench_fragmented<turbo::http::request<>>("branches", buffer, fragment, iterations);
+    bench_fragmented<turbo::http::request<16, bench_goto_policy>>("computed_goto", buffer, fragment, iterations);
+}
+
+struct bench_dfa_policy : public turbo::http::lenient_policy
+{
+    static constexpr turbo::http::dispatch_engine dispatch{turbo::http::dispatch_engine::dfa};
+};
+
+struct bench_strict_dfa_policy : public turbo::http::strict_policy
+{
+    static constexpr turbo::http::dispatch_engine dispatch{turbo::http::dispatch_engine::dfa};
+};
+
+TEST_CASE("Benchmark dfa")
+{
+    // The same request as "Benchmark" so the engines can be compared per policy.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 200'000;
+
+    std::cout << "dfa lenient_policy\n";
+    bench_request<turbo::http::request<16, bench_dfa_policy>>(buffer, iterations);
+    std::cout << "dfa strict_policy\n";
+    bench_request<turbo::http::request<16, bench_strict_dfa_policy>>(buffer, iterations);
+
+    REQUIRE(true);
+}
+
+struct bench_layout_policy : public turbo::http::lenient_policy
+{
+    static constexpr std::size_t header_layout_bytes{256};
+};
+
+struct bench_strict_layout_policy : public turbo::http::strict_policy
+{
+    static constexpr std::size_t header_layout_bytes{256};
+};
+
+TEST_CASE("Benchmark header layout")
+{
+    // bench_request() parses the same request on one parser, a keep-alive client at a 100% hit rate.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 200'000;
+
+    std::cout << "header layout lenient_policy\n";
+    bench_request<turbo::http::request<16, bench_layout_policy>>(buffer, iterations);
+    std::cout << "header layout strict_policy\n";
+    bench_request<turbo::http::request<16, bench_strict_layout_policy>>(buffer, iterations);
+
+    turbo::http::request<16, bench_layout_policy> request{};
+    request.parse(buffer);
+    request.reset();
+    request.parse(buffer);
+    std::cout << "header layout hit rate: " << request.header_layout_stats().hit_rate() << "\n";
+    REQUIRE(request.header_layout_stats().hit_rate() == 0.5);
+}
+
+TEST_CASE("Benchmark scratch_pool")
+{
+    // Each parse binds a pooled parser to the connection's detached state and unbinds it again.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 200'000;
+
+    turbo::http::scratch_pool<turbo::http::request<>, 1> pool{};
+    turbo::http::request_state state{};
+    size_t completed{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        state = {};
+        auto* parser = pool.bind(state, buffer);
+        if(parser->parse(buffer) == turbo::http::request_parse_result::complete)
+        {
+            ++completed;
+        }
+        pool.unbind(parser, state);
+    }
+    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
 
     double requests_per_second = ((double)iterations) / total_ms * 1000;
-    std::cout << "requests/sec: " << (uint64_t)requests_per_second << "\n";
+    std::cout << "sizeof(request<>): " << sizeof(turbo::http::request<>) << " sizeof(request_state): " << sizeof(turbo::http::request_state) << "\n";
+    std::cout << "scratch_pool requests/sec: " << (uint64_t)requests_per_second << "\n";
     std::cout << "MegaBytes per second: " << (buffer.length() * requests_per_second) / 1024 / 1024 << "\n";
+    REQUIRE(completed == iterations);
+}
 
-    REQUIRE(true);
+TEST_CASE("Benchmark checkpoint")
+{
+    // Migrating a request that stopped just before its last header.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 200'000;
+    std::span<const char> partial{buffer.data(), buffer.rfind("Cookie:")};
+
+    turbo::http::request<> parser{};
+    parser.parse(partial);
+    std::vector<std::byte> blob(parser.checkpoint_size());
+    parser.checkpoint(blob);
+
+    size_t restored{0};
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        turbo::http::request<> migrated{};
+        if(migrated.restore(blob, partial))
+        {
+            restored += migrated.http_header_count();
+        }
+        migrated.checkpoint(blob);
+    }
+    auto restore_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(partial);
+    }
+    auto reparse_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    turbo::http::request<16, turbo::http::strict_policy> strict{};
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        strict.reset();
+        strict.parse(partial);
+    }
+    auto strict_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "checkpoint + restore ms: " << restore_ms << " reparse ms: " << reparse_ms << " strict reparse ms: " << strict_ms << "\n";
+    REQUIRE(restored == iterations * 8);
+}
+
+TEST_CASE("Benchmark clone_into")
+{
+    // The I/O thread parses and clones into the worker's arena, the worker releases it afterwards.
+    std::string buffer = bench_request_buffer;
+    constexpr size_t iterations = 200'000;
+
+    std::array<std::byte, 4096> storage{};
+    std::pmr::monotonic_buffer_resource arena{storage.data(), storage.size()};
+    turbo::http::request<> parser{};
+    size_t cloned{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(buffer);
+        auto clone = parser.clone_into(arena);
+        cloned += clone.http_header_count();
+        arena.release();
+    }
+    auto total_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    double requests_per_second = ((double)iterations) / total_ms * 1000;
+    std::cout << "parse + clone_into requests/sec: " << (uint64_t)requests_per_second << "\n";
+    REQUIRE(cloned == iterations * 9);
+}
+
+TEST_CASE("Benchmark buffer_pool")
+{
+    // Many keep-alive connections each receive a request into their own buffer in a random order,
+    // heap allocated std::string buffers against buffers carved from the pool's 2 MB slabs.
+    constexpr size_t connections = 16'384;
+    constexpr size_t iterations = 200'000;
+    const std::string_view received = bench_request_buffer;
+
+    std::vector<uint32_t> order(iterations);
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<uint32_t> pick{0, connections - 1};
+    std::generate(order.begin(), order.end(), [&]() { return pick(rng); });
+
+    std::vector<std::string> heap_buffers(connections);
+    for(auto& heap_buffer : heap_buffers)
+    {
+        heap_buffer.reserve(4096);
+    }
+    turbo::http::request<> parser{};
+    size_t completed{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(auto index : order)
+    {
+        auto& heap_buffer = heap_buffers[index];
+        heap_buffer.append(received);
+        if(parser.parse(heap_buffer) == turbo::http::request_parse_result::complete)
+        {
+            ++completed;
+            heap_buffer.erase(0, parser.bytes_consumed());
+            parser.reset();
+        }
+    }
+    auto heap_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    turbo::http::buffer_pool pool{};
+    std::vector<turbo::http::connection_buffer> pooled_buffers{};
+    pooled_buffers.reserve(connections);
+    for(size_t i = 0; i < connections; ++i)
+    {
+        pooled_buffers.push_back(pool.acquire(4096));
+    }
+
+    start = std::chrono::steady_clock::now();
+    for(auto index : order)
+    {
+        auto& pooled_buffer = pooled_buffers[index];
+        pooled_buffer.append(received);
+        auto data = pooled_buffer.data();
+        if(parser.parse(data) == turbo::http::request_parse_result::complete)
+        {
+            ++completed;
+            pooled_buffer.next_message(parser);
+        }
+    }
+    auto pool_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "slabs: " << pool.stats().slabs << " hugepage slabs: " << pool.stats().hugepage_slabs << "\n";
+    std::cout << "heap buffers ms: " << heap_ms << " pooled buffers ms: " << pool_ms << "\n";
+    REQUIRE(completed == iterations * 2);
+}
+
+TEST_CASE("Benchmark connection_parser")
+{
+    // A keep-alive connection receiving pipelined requests in 1400 byte segments, the hand written
+    // loop erases each request from the front of a std::string.
+    constexpr size_t iterations = 200'000;
+    constexpr size_t segment = 1400;
+    std::string stream{};
+    for(size_t i = 0; i < 64; ++i)
+    {
+        stream += bench_request_buffer;
+    }
+    const size_t rounds = iterations / 64;
+
+    turbo::http::request<> parser{};
+    std::string buffer{};
+    size_t completed{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < rounds; ++round)
+    {
+        for(size_t offset = 0; offset < stream.length(); offset += segment)
+        {
+            buffer.append(stream, offset, segment);
+            while(parser.parse(buffer) == turbo::http::request_parse_result::complete)
+            {
+                ++completed;
+                buffer.erase(0, parser.bytes_consumed());
+                parser.reset();
+            }
+        }
+    }
+    auto loop_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    turbo::http::connection_parser<turbo::http::request<>> connection{};
+    start = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < rounds; ++round)
+    {
+        for(size_t offset = 0; offset < stream.length(); offset += segment)
+        {
+            connection.append(std::string_view{stream}.substr(offset, segment));
+            for([[maybe_unused]] auto& request : connection)
+            {
+                ++completed;
+            }
+        }
+    }
+    auto connection_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "erase loop ms: " << loop_ms << " connection_parser ms: " << connection_ms << "\n";
+    REQUIRE(completed == rounds * 64 * 2);
+}
+
+TEST_CASE("Benchmark query params")
+{
+    // An API gateway reading five query parameters, looked up in place against copied into a std::map.
+    std::string buffer =
+        "GET /v1/search?api_key=0123456789abcdef&q=hello+kitty&lang=en&page=2&per_page=50&sort=relevance&fmt=json HTTP/1.1\r\n"
+        "Host: api.example.com\r\n"
+        "\r\n";
+    constexpr size_t iterations = 200'000;
+    constexpr std::array<std::string_view, 5> keys{"api_key", "q", "page", "per_page", "fmt"};
+
+    turbo::http::request<> parser{};
+    size_t found{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(buffer);
+        std::map<std::string, std::string> params{};
+        for(const auto& [key, value] : parser.http_query_params())
+        {
+            params.emplace(std::string{key}, std::string{value});
+        }
+        for(auto key : keys)
+        {
+            found += params.count(std::string{key});
+        }
+    }
+    auto map_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(buffer);
+        for(auto key : keys)
+        {
+            found += parser.http_query_param(key).has_value();
+        }
+    }
+    auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "std::map ms: " << map_ms << " http_query_param ms: " << lookup_ms << "\n";
+    REQUIRE(found == iterations * keys.size() * 2);
+}
+
+TEST_CASE("Benchmark percent decoding")
+{
+    // Decoding in place, each value is restored from its encoded copy before decoding it again.
+    const std::vector<std::pair<std::string_view, std::string>> values{
+        {"sparse", "/wp-content/uploads/2010/03/hello-kitty%20darth-vader-pink-and-black-wallpaper-1920x1080.jpg"},
+        {"dense", "%E3%81%93%E3%82%93%E3%81%AB%E3%81%A1%E3%81%AF%E4%B8%96%E7%95%8C+%F0%9F%98%BA"},
+        {"form", "first+name=Hello+Kitty&comment=I+like+the+pink+one%21+Do+you+have+it+in+black%3F"}
+    };
+    constexpr size_t iterations = 200'000;
+
+    for(const auto& [name, encoded] : values)
+    {
+        std::string buffer = encoded;
+        size_t decoded{0};
+
+        auto start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            std::memcpy(buffer.data(), encoded.data(), encoded.length());
+            decoded += turbo::http::percent_detail::decode_scalar(buffer, buffer.data(), turbo::http::plus_decoding::space).value();
+        }
+        auto scalar_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            std::memcpy(buffer.data(), encoded.data(), encoded.length());
+            decoded -= turbo::http::percent_decode_in_place(buffer, buffer, turbo::http::plus_decoding::space).value().length();
+        }
+        auto vector_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << name << " scalar us: " << scalar_us << " vectorized us: " << vector_us << "\n";
+        REQUIRE(decoded == 0);
+    }
+}
+
+TEST_CASE("Benchmark path normalization")
+{
+    // A cache keying on the normalized path, parsing alone against parsing and normalizing in place.
+    const std::string data =
+        "GET /static//assets/./js/../css/%7Esite/theme%2dpink/main.css?v=3 HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "\r\n";
+    constexpr size_t iterations = 200'000;
+
+    turbo::http::request<> parser{};
+    std::string buffer{};
+    size_t length{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        buffer = data;
+        parser.reset();
+        parser.parse(buffer);
+        length += parser.http_path().length();
+    }
+    auto parse_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        buffer = data;
+        parser.reset();
+        parser.parse(buffer);
+        length += turbo::http::normalize_path_in_place(buffer, parser.http_path()).value().length();
+    }
+    auto normalize_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "parse ms: " << parse_ms << " parse and normalize_path_in_place ms: " << normalize_ms << "\n";
+    REQUIRE(length == iterations * (std::string_view{"/static//assets/./js/../css/%7Esite/theme%2dpink/main.css"}.length()
+                                    + std::string_view{"/static/assets/css/~site/theme-pink/main.css"}.length()));
+}
+
+TEST_CASE("Benchmark absolute-form targets")
+{
+    // A forward proxy reading the host, port and path of each request, the origin-form request is the baseline.
+    const std::string origin =
+        "GET /v1/search?q=hello+kitty HTTP/1.1\r\n"
+        "Host: api.example.com:8080\r\n"
+        "\r\n";
+    const std::string absolute =
+        "GET http://api.example.com:8080/v1/search?q=hello+kitty HTTP/1.1\r\n"
+        "Host: api.example.com:8080\r\n"
+        "\r\n";
+    constexpr size_t iterations = 200'000;
+
+    turbo::http::request<> parser{};
+    size_t length{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(std::span<const char>{origin});
+        length += parser.http_path().length();
+    }
+    auto origin_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        parser.reset();
+        parser.parse(std::span<const char>{absolute});
+        length += parser.http_path().length() + parser.http_target_host().length() + (parser.http_target_port() == 8080 ? 1 : 0);
+    }
+    auto absolute_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "origin-form ms: " << origin_ms << " absolute-form with host and port ms: " << absolute_ms << "\n";
+    REQUIRE(length == iterations * (2 * std::string_view{"/v1/search"}.length() + std::string_view{"api.example.com"}.length() + 1));
+}
+
+TEST_CASE("Benchmark virtual host dispatch")
+{
+    // A server routing each request to its virtual host, hashing the Host header value itself is the baseline.
+    const std::string data =
+        "GET /index.html HTTP/1.1\r\n"
+        "User-Agent: Mozilla/5.0\r\n"
+        "Host: WWW.Example.COM:8080\r\n"
+        "Accept: */*\r\n"
+        "\r\n";
+    const std::unordered_map<std::string_view, size_t, turbo::http::host_hasher, turbo::http::host_equal> vhosts{
+        {"api.example.com", 1}, {"www.example.com", 2}, {"static.example.com", 3}};
+    constexpr size_t iterations = 200'000;
+
+    turbo::http::request<> parser{};
+    std::string buffer{};
+    size_t hits{0};
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        buffer = data;
+        parser.reset();
+        parser.parse(buffer);
+        // Strip the port and lowercase a copy of the host for the lookup.
+        auto value = parser.http_header("Host").value();
+        std::string host{value.substr(0, value.find(':'))};
+        std::transform(host.begin(), host.end(), host.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        hits += vhosts.at(host);
+    }
+    auto header_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        buffer = data;
+        parser.reset();
+        parser.parse(buffer);
+        hits += vhosts.find(parser.http_host_key())->second;
+    }
+    auto host_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        buffer = data;
+        parser.reset();
+        parser.parse(buffer);
+        // The hashes of the known hosts are compile time constants.
+        switch(parser.http_host_hash())
+        {
+            case turbo::http::host_hash("api.example.com"): hits += 1; break;
+            case turbo::http::host_hash("www.example.com"): hits += 2; break;
+            case turbo::http::host_hash("static.example.com"): hits += 3; break;
+            default: break;
+        }
+    }
+    auto hash_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "http_header(\"Host\") lowercased copy ms: " << header_ms << " http_host_key() ms: " << host_ms
+              << " http_host_hash() ms: " << hash_ms << "\n";
+    REQUIRE(hits == 3 * iterations * 2);
 }
@@ -0,0 +1,213 @@
+#include "catch.hpp"
+#include <turbohttp/turbohttp.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace turbo::http;
+
+class request_recorder : public request_event_parser<request_recorder>
+{
+public:
+    auto on_method(method m) -> request_parse_result
+    {
+        m_method = m;
+        return request_parse_result::advance;
+    }
+
+    auto on_uri(std::string_view uri) -> request_parse_result
+    {
+        m_uri = uri;
+        return request_parse_result::advance;
+    }
+
+    auto on_header(std::string_view name, std::string_view value) -> request_parse_result
+    {
+        m_headers.emplace_back(name, value);
+        return (name == "X-Reject") ? request_parse_result::rejected : request_parse_result::advance;
+    }
+
+    auto on_headers_complete() -> request_parse_result
+    {
+        m_headers_complete = true;
+        return request_parse_result::advance;
+    }
+
+    auto on_body(std::span<char> body) -> request_parse_result
+    {
+        m_body.append(body.data(), body.size());
+        return request_parse_result::advance;
+    }
+
+    method m_method{method::get};
+    std::string m_uri{};
+    std::vector<std::pair<std::string, std::string>> m_headers{};
+    bool m_headers_complete{false};
+    std::string m_body{};
+};
+
+class response_recorder : public response_event_parser<response_recorder>
+{
+public:
+    auto on_status_code(uint64_t status_code) -> response_parse_result
+    {
+        m_status_code = status_code;
+        return response_parse_result::advance;
+    }
+
+    auto on_body(std::span<char> body) -> response_parse_result
+    {
+        m_body.append(body.data(), body.size());
+        return response_parse_result::advance;
+    }
+
+    uint64_t m_status_code{0};
+    std::string m_body{};
+};
+
+SCENARIO("EVENT:Parsing a request with more headers than the storing parser allows.")
+{
+    GIVEN("A request with 32 headers")
+    {
+        std::string request_data = "GET /derp.html HTTP/1.1\r\n";
+        for(std::size_t i = 0; i < 32; ++i)
+        {
+            request_data += "X-Header-" + std::to_string(i) + ": " + std::to_string(i) + "\r\n";
+        }
+        request_data += "\r\n";
+        request_recorder recorder{};
+
+        WHEN("Parsed")
+        {
+            auto result = recorder.parse(request_data);
+            THEN("We expect every header to be handed to the handler.")
+            {
+                REQUIRE(result == request_parse_result::complete);
+                REQUIRE(recorder.state() == request_parse_state::parsed_headers);
+                REQUIRE(recorder.m_method == method::get);
+                REQUIRE(recorder.m_uri == "/derp.html");
+                REQUIRE(recorder.http_header_count() == 32);
+                REQUIRE(recorder.m_headers.size() == 32);
+                REQUIRE(recorder.m_headers[31].first == "X-Header-31");
+                REQUIRE(recorder.m_headers[31].second == "31");
+                REQUIRE(recorder.m_headers_complete);
+            }
+        }
+    }
+}
+
+SCENARIO("EVENT:Parsing a fragmented chunked request.")
+{
+    GIVEN("A chunked POST request delivered in pieces")
+    {
+        std::string full =
+            "POST /derp.html HTTP/1.1\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "4\r\n"
+            "Wiki\r\n"
+            "5\r\n"
+            "pedia\r\n"
+            "0\r\n"
+            "\r\n";
+        std::string original = full;
+        request_recorder recorder{};
+
+        WHEN("Parsed one byte at a time")
+        {
+            request_parse_result result{request_parse_result::incomplete};
+            for(std::size_t i = 1; i <= full.size(); ++i)
+            {
+                std::span<char> data{full.data(), i};
+                result = recorder.parse(data);
+                if(result != request_parse_result::incomplete)
+                {
+                    break;
+                }
+            }
+
+            THEN("We expect each chunk to be delivered once and the data to be untouched.")
+            {
+                REQUIRE(result == request_parse_result::complete);
+                REQUIRE(recorder.state() == request_parse_state::parsed_body);
+                REQUIRE(recorder.m_uri == "/derp.html");
+                REQUIRE(recorder.m_body == "Wikipedia");
+                REQUIRE(full == original);
+            }
+        }
+    }
+}
+
+SCENARIO("EVENT:A handler can stop parsing.")
+{
+    GIVEN("A request with a header the handler rejects")
+    {
+        std::string request_data =
+            "GET /derp.html HTTP/1.1\r\n"
+            "X-Reject: yes\r\n"
+            "Accept: */*\r\n"
+            "\r\n";
+        request_recorder recorder{};
+
+        WHEN("Parsed")
+        {
+            auto result = recorder.parse(request_data);
+            THEN("We expect the handler's result.")
+            {
+                REQUIRE(result == request_parse_result::rejected);
+                REQUIRE(recorder.m_headers.size() == 1);
+                REQUIRE(!recorder.m_headers_complete);
+            }
+        }
+    }
+}
+
+SCENARIO("EVENT:Parsing a response with a Content-Length body.")
+{
+    GIVEN("A response with a body")
+    {
+        std::string response_data =
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n"
+            "12345";
+        response_recorder recorder{};
+
+        WHEN("Parsed")
+        {
+            auto result = recorder.parse(response_data);
+            THEN("We expect the status code and body events.")
+            {
+                REQUIRE(result == response_parse_result::complete);
+                REQUIRE(recorder.state() == response_parse_state::parsed_body);
+                REQUIRE(recorder.m_status_code == 404);
+                REQUIRE(recorder.http_header_count() == 1);
+                REQUIRE(recorder.m_body == "12345");
+            }
+        }
+    }
+}
+
+SCENARIO("EVENT:Parsing a request with a Content-Length larger than any data could hold.")
+{
+    GIVEN("A Content-Length of SIZE_MAX")
+    {
+        std::string request_data =
+            "POST / HTTP/1.1\r\n"
+            "Content-Length: 18446744073709551615\r\n"
+            "\r\n"
+            "abc";
+        request_recorder recorder{};
+
+        WHEN("Parsed")
+        {
+            auto result = recorder.parse(request_data);
+            THEN("We expect no body event until the body arrives.")
+            {
+                REQUIRE(result == request_parse_result::incomplete);
+                REQUIRE(recorder.m_headers_complete);
+                REQUIRE(recorder.m_body.empty());
+            }
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #include "catch.hpp"
 #include <turbohttp/turbohttp.hpp>
 
+#include <vector>
+
 using namespace turbo::http;
 
 SCENARIO("RESPONSE: Parsing an empty string.")
@@ -1836,4 +1838,259 @@ SCENARIO("RESPONSE: Parsing a content length http_body.")
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("RESPONSE: Resuming the version of a partial status line.")
+{
+    GIVEN("A status line cut at every byte")
+    {
+        std::string response_data = "HTTP/1.0 200 OK\r\n\r\n";
+
+        WHEN("The cut response is parsed and then the whole one")
+        {
+            THEN("We expect the same version and status as parsing it whole.")
+            {
+                for(std::size_t cut = 1; cut < response_data.size(); ++cut)
+                {
+                    response response{};
+                    std::span<char> partial{response_data.data(), cut};
+                    REQUIRE(response.parse(partial) == response_parse_result::incomplete);
+                    REQUIRE(response.parse(response_data) == response_parse_result::complete);
+                    REQUIRE(response.http_version() == version::v1_0);
+                    REQUIRE(response.http_status_code() == 200);
+                    REQUIRE(response.http_reason_phrase() == "OK");
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("RESPONSE: Parsing with the strict policy.")
+{
+    GIVEN("A response with an invalid header name")
+    {
+        std::string response_data =
+            "HTTP/1.1 200 OK\r\n"
+            "X(Bad): value\r\n"
+            "\r\n";
+        response<16, strict_policy> response{};
+
+        WHEN("Parsed")
+        {
+            auto result = response.parse(response_data);
+            THEN("We expect header_malformed.")
+            {
+                REQUIRE(result == response_parse_result::header_malformed);
+                REQUIRE(response.state() == response_parse_state::parsed_reason_phrase);
+            }
+        }
+    }
+
+    GIVEN("A response with a valid Content-Length body")
+    {
+        std::string response_data =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n"
+            "12345";
+        response<16, strict_policy> response{};
+
+        WHEN("Parsed")
+        {
+            auto result = response.parse(response_data);
+            THEN("We expect the body to be parsed.")
+            {
+                REQUIRE(result == response_parse_result::complete);
+                REQUIRE(response.http_body().value() == "12345");
+            }
+        }
+    }
+}
+
+struct limited_response_policy : public strict_policy
+{
+    static constexpr std::size_t max_header_bytes{32};
+    static constexpr std::size_t max_body_length{4};
+};
+
+SCENARIO("RESPONSE: Parsing with policy limits.")
+{
+    GIVEN("A response with a header block over the limit")
+    {
+        std::string response_data =
+            "HTTP/1.1 200 OK\r\n"
+            "Server: 1234567890\r\n"
+            "Date: 1234567890\r\n"
+            "\r\n";
+        response<16, limited_response_policy> response{};
+
+        WHEN("Parsed")
+        {
+            auto result = response.parse(response_data);
+            THEN("We expect headers_too_large.")
+            {
+                REQUIRE(result == response_parse_result::headers_too_large);
+            }
+        }
+    }
+
+    GIVEN("A response with a Content-Length over the limit")
+    {
+        std::string response_data =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n";
+        response<16, limited_response_policy> response{};
+
+        WHEN("Parsed")
+        {
+            auto result = response.parse(response_data);
+            THEN("We expect body_too_large.")
+            {
+                REQUIRE(result == response_parse_result::body_too_large);
+            }
+        }
+    }
+}
+
+struct goto_response_policy : public lenient_policy
+{
+    static constexpr dispatch_engine dispatch{dispatch_engine::computed_goto};
+};
+
+SCENARIO("RESPONSE: Parsing with the computed goto dispatch engine.")
+{
+    GIVEN("A response with a Content-Length body")
+    {
+        std::string response_data =
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n"
+            "12345";
+        response<16, goto_response_policy> response{};
+
+        WHEN("Parsed one byte at a time")
+        {
+            response_parse_result result{response_parse_result::incomplete};
+            std::size_t length{0};
+            while(result == response_parse_result::incomplete && length < response_data.size())
+            {
+                std::span<char> data{response_data.data(), ++length};
+                result = response.parse(data);
+            }
+
+            THEN("We expect the same result as parsing it whole.")
+            {
+                REQUIRE(result == response_parse_result::complete);
+                REQUIRE(length == response_data.size());
+                REQUIRE(response.http_status_code() == 200);
+                REQUIRE(response.http_reason_phrase() == "OK");
+                REQUIRE(response.http_body().value() == "12345");
+            }
+        }
+    }
+}
+
+struct strict_dfa_response_policy : public strict_policy
+{
+    static constexpr dispatch_engine dispatch{dispatch_engine::dfa};
+};
+
+SCENARIO("RESPONSE: Parsing with the DFA dispatch engine.")
+{
+    GIVEN("A response with a chunked body")
+    {
+        std::string response_data =
+            "HTTP/1.0 404 Not Found\r\n"
+            "Server: turbo\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "\r\n"
+            "3\r\n"
+            "abc\r\n"
+            "0\r\n"
+            "\r\n";
+        response<16, strict_dfa_response_policy> response{};
+
+        WHEN("Parsed one byte at a time")
+        {
+            response_parse_result result{response_parse_result::incomplete};
+            std::size_t length{0};
+            while(result == response_parse_result::incomplete && length < response_data.size())
+            {
+                std::span<char> data{response_data.data(), ++length};
+                result = response.parse(data);
+            }
+
+            THEN("We expect the same result as parsing it whole.")
+            {
+                REQUIRE(result == response_parse_result::complete);
+                REQUIRE(length == response_data.size());
+                REQUIRE(response.http_version() == version::v1_0);
+                REQUIRE(response.http_status_code() == 404);
+                REQUIRE(response.http_reason_phrase() == "Not Found");
+                REQUIRE(response.http_header("Server").value() == "turbo");
+                REQUIRE(response.http_body().value() == "abc");
+            }
+        }
+    }
+    GIVEN("Malformed status lines")
+    {
+        std::vector<std::pair<std::string, response_parse_result>> cases{
+            {"HTTP/1.1 000 OK\r\n\r\n", response_parse_result::http_status_code_malformed},
+            {"HTTP/1.1 2x0 OK\r\n\r\n", response_parse_result::http_status_code_malformed},
+            {"HTTP/1.1 2000 OK\r\n\r\n", response_parse_result::http_status_code_malformed},
+            {"HTTP/1.2 200 OK\r\n\r\n", response_parse_result::http_version_unknown},
+            {"HTTP/1.1200 OK\r\n\r\n", response_parse_result::http_version_malformed},
+            {"HTTP/1.1 200 OK\r\nBad Name: x\r\n\r\n", response_parse_result::header_malformed}
+        };
+
+        for(auto& [response_data, expected] : cases)
+        {
+            response<16, strict_dfa_response_policy> response{};
+            INFO(response_data);
+            REQUIRE(response.parse(response_data) == expected);
+        }
+    }
+}
+
+SCENARIO("RESPONSE: Checkpointing and restoring a partially parsed response.")
+{
+    GIVEN("A response checkpointed after every byte.")
+    {
+        const std::string response_data =
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 5\r\n"
+            "\r\n"
+            "nope!";
+
+        WHEN("Each byte is parsed by a parser restored from the previous checkpoint")
+        {
+            std::vector<std::byte> blob(checkpoint_layout::size);
+            response<>{}.checkpoint(blob);
+            response_parse_result result{response_parse_result::incomplete};
+            std::size_t length{0};
+            while(result == response_parse_result::incomplete && length < response_data.size())
+            {
+                std::span<const char> data{response_data.data(), ++length};
+                response<> parser{};
+                REQUIRE(parser.restore(blob, data));
+                result = parser.parse(data);
+                blob.resize(parser.checkpoint_size());
+                parser.checkpoint(blob);
+            }
+
+            THEN("We expect the same response as parsing it in one go.")
+            {
+                REQUIRE(result == response_parse_result::complete);
+                response<> parser{};
+                REQUIRE(parser.restore(blob, std::span<const char>{response_data}));
+                REQUIRE(parser.http_status_code() == 404);
+                REQUIRE(parser.http_reason_phrase() == "Not Found");
+                REQUIRE(parser.http_header_count() == 2);
+                REQUIRE(parser.http_header("Content-Type").value() == "text/plain");
+                REQUIRE(parser.http_body().value() == "nope!");
+                REQUIRE_FALSE(parser.restore(blob, std::span<const char>{response_data.data(), 10}));
+            }
+        }
+    }
+}
@@ -0,0 +1,339 @@
+/**
+ * turbohttp_replay parses a capture file of concatenated raw HTTP requests (or responses) as fast
+ * as possible and reports throughput, histograms and the offsets of every message that failed to
+ * parse.  The file is memory mapped read-only, split into one region per thread and each region is
+ * moved forward to the next request line (or status line) so no message is shared by two threads.
+ *
+ *     turbohttp_replay [--responses] [--strict] [--threads N] capture.http
+ */
+
+#include <turbohttp/turbohttp.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace turbo::http;
+
+/// Captured traffic can carry far more headers than the library default.
+static constexpr std::size_t replay_header_count = 64;
+/// The number of error offsets printed, all of them are counted.
+static constexpr std::size_t replay_errors_printed = 32;
+
+static constexpr std::array<std::string_view, 9> request_line_methods{
+    "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH "
+};
+
+struct replay_error
+{
+    /// The offset into the file of the start of the message.
+    std::size_t offset{0};
+    /// The parse result, either a request_parse_result or response_parse_result.
+    int result{0};
+};
+
+struct replay_stats
+{
+    std::uint64_t messages{0};
+    std::uint64_t bytes{0};
+    std::array<std::uint64_t, 9> methods{};
+    std::array<std::uint64_t, 1000> status_codes{};
+    std::array<std::uint64_t, replay_header_count + 1> header_counts{};
+    std::vector<replay_error> errors{};
+};
+
+/**
+ * @return True if the line at 'pos' looks like a request line ("METHOD uri HTTP/1.x") or a
+ *         status line ("HTTP/1.x ...").
+ */
+static auto is_message_start(std::string_view data, std::size_t pos, bool responses) -> bool
+{
+    auto line_end = data.find("\r\n", pos);
+    if(line_end == std::string_view::npos)
+    {
+        return false;
+    }
+    auto line = data.substr(pos, line_end - pos);
+
+    if(responses)
+    {
+        return line.starts_with("HTTP/1.");
+    }
+
+    bool method_found = std::any_of(
+        request_line_methods.begin(),
+        request_line_methods.end(),
+        [&line](std::string_view m) { return line.starts_with(m); }
+    );
+    return method_found && line.length() >= 8 && line.substr(line.length() - 8).starts_with("HTTP/1.");
+}
+
+/**
+ * @return The offset of the first message start at or after 'pos', otherwise the data length.
+ */
+static auto resync(std::string_view data, std::size_t pos, bool responses) -> std::size_t
+{
+    while(pos < data.length())
+    {
+        // Messages always start at the beginning of a line.
+        if((pos == 0 || data[pos - 1] == '\n') && is_message_start(data, pos, responses))
+        {
+            return pos;
+        }
+
+        auto next_line = data.find('\n', pos);
+        if(next_line == std::string_view::npos)
+        {
+            break;
+        }
+        pos = next_line + 1;
+    }
+    return data.length();
+}
+
+template<typename parser_type>
+static auto record(const parser_type& parser, replay_stats& stats) -> void
+{
+    if constexpr(requires { parser.http_method(); })
+    {
+        ++stats.methods[static_cast<std::size_t>(parser.http_method())];
+    }
+    else
+    {
+        ++stats.status_codes[std::min<std::uint64_t>(parser.http_status_code(), stats.status_codes.size() - 1)];
+    }
+    ++stats.header_counts[parser.http_header_count()];
+}
+
+/**
+ * Parses every message in [begin, end) of 'data', on an error the parser resyncs on the next message start.
+ */
+template<typename parser_type>
+static auto replay_region(std::string_view data, std::size_t begin, std::size_t end, bool responses, replay_stats& stats) -> void
+{
+    auto region = data.substr(0, end);
+    parser_type parser{};
+    std::size_t pos = begin;
+
+    while(pos < end)
+    {
+        parser.reset();
+        auto result = parser.parse(std::span<const char>{region.data() + pos, end - pos});
+
+        if(result == decltype(result)::complete)
+        {
+            ++stats.messages;
+            stats.bytes += parser.bytes_consumed();
+            record(parser, stats);
+            pos += parser.bytes_consumed();
+        }
+        else
+        {
+            // Incomplete can only happen with a message truncated at the end of the region.
+            stats.errors.push_back(replay_error{pos, static_cast<int>(result)});
+            pos = resync(region, pos + 1, responses);
+        }
+    }
+}
+
+template<typename parser_type>
+static auto replay(std::string_view data, std::size_t thread_count, bool responses) -> int
+{
+    // Split the file into one region per thread, each region starts on a message boundary.
+    std::vector<std::size_t> boundaries{};
+    boundaries.push_back(resync(data, 0, responses));
+    for(std::size_t i = 1; i < thread_count; ++i)
+    {
+        auto nominal = std::max(data.length() / thread_count * i, boundaries.back());
+        boundaries.push_back(resync(data, nominal, responses));
+    }
+    boundaries.push_back(data.length());
+
+    std::vector<replay_stats> stats(thread_count);
+    std::vector<std::thread> threads{};
+
+    auto start = std::chrono::steady_clock::now();
+    for(std::size_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(
+            replay_region<parser_type>, data, boundaries[i], boundaries[i + 1], responses, std::ref(stats[i])
+        );
+    }
+    for(auto& t : threads)
+    {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    replay_stats total{};
+    for(auto& s : stats)
+    {
+        total.messages += s.messages;
+        total.bytes += s.bytes;
+        for(std::size_t i = 0; i < total.methods.size(); ++i) { total.methods[i] += s.methods[i]; }
+        for(std::size_t i = 0; i < total.status_codes.size(); ++i) { total.status_codes[i] += s.status_codes[i]; }
+        for(std::size_t i = 0; i < total.header_counts.size(); ++i) { total.header_counts[i] += s.header_counts[i]; }
+        total.errors.insert(total.errors.end(), s.errors.begin(), s.errors.end());
+    }
+
+    std::cout << "threads:    " << thread_count << "\n";
+    std::cout << "file bytes: " << data.length() << "\n";
+    std::cout << "messages:   " << total.messages << "\n";
+    std::cout << "errors:     " << total.errors.size() << "\n";
+    std::cout << "seconds:    " << elapsed << "\n";
+    std::cout << "GB/s:       " << (static_cast<double>(data.length()) / elapsed / 1e9) << "\n";
+    std::cout << "messages/s: " << (static_cast<double>(total.messages) / elapsed) << "\n";
+
+    if(responses)
+    {
+        std::cout << "\nstatus codes:\n";
+        for(std::size_t i = 0; i < total.status_codes.size(); ++i)
+        {
+            if(total.status_codes[i] != 0)
+            {
+                std::cout << "    " << i << ": " << total.status_codes[i] << "\n";
+            }
+        }
+    }
+    else
+    {
+        std::cout << "\nmethods:\n";
+        for(std::size_t i = 0; i < total.methods.size(); ++i)
+        {
+            if(total.methods[i] != 0)
+            {
+                std::cout << "    " << to_string(static_cast<method>(i)) << ": " << total.methods[i] << "\n";
+            }
+        }
+    }
+
+    std::cout << "\nheader counts:\n";
+    for(std::size_t i = 0; i < total.header_counts.size(); ++i)
+    {
+        if(total.header_counts[i] != 0)
+        {
+            std::cout << "    " << i << ": " << total.header_counts[i] << "\n";
+        }
+    }
+
+    if(!total.errors.empty())
+    {
+        std::sort(
+            total.errors.begin(),
+            total.errors.end(),
+            [](const replay_error& a, const replay_error& b) { return a.offset < b.offset; }
+        );
+        std::cout << "\nerror offsets (offset: parse result):\n";
+        for(std::size_t i = 0; i < std::min(total.errors.size(), replay_errors_printed); ++i)
+        {
+            std::cout << "    " << total.errors[i].offset << ": " << total.errors[i].result << "\n";
+        }
+        if(total.errors.size() > replay_errors_printed)
+        {
+            std::cout << "    ... " << (total.errors.size() - replay_errors_printed) << " more\n";
+        }
+    }
+
+    return total.errors.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static auto usage(const char* name) -> int
+{
+    std::cerr << "usage: " << name << " [--responses] [--strict] [--threads N] capture.http\n";
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+    bool responses = false;
+    bool strict = false;
+    std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    const char* path = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        if(arg == "--responses")
+        {
+            responses = true;
+        }
+        else if(arg == "--strict")
+        {
+            strict = true;
+        }
+        else if(arg == "--threads" && i + 1 < argc)
+        {
+            thread_count = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if(path == nullptr)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            return usage(argv[0]);
+        }
+    }
+
+    if(path == nullptr)
+    {
+        return usage(argv[0]);
+    }
+
+    int fd = ::open(path, O_RDONLY);
+    if(fd == -1)
+    {
+        std::cerr << "failed to open " << path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    struct stat st{};
+    if(::fstat(fd, &st) == -1 || st.st_size == 0)
+    {
+        std::cerr << "failed to stat or empty file " << path << "\n";
+        ::close(fd);
+        return EXIT_FAILURE;
+    }
+
+    auto length = static_cast<std::size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED)
+    {
+        std::cerr << "failed to mmap " << path << "\n";
+        return EXIT_FAILURE;
+    }
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+
+    std::string_view data{static_cast<const char*>(mapped), length};
+
+    int result;
+    if(responses)
+    {
+        result = strict
+            ? replay<response<replay_header_count, strict_policy>>(data, thread_count, responses)
+            : replay<response<replay_header_count, lenient_policy>>(data, thread_count, responses);
+    }
+    else
+    {
+        result = strict
+            ? replay<request<replay_header_count, strict_policy>>(data, thread_count, responses)
+            : replay<request<replay_header_count, lenient_policy>>(data, thread_count, responses);
+    }
+
+    ::munmap(mapped, length);
+    return result;
+}